@@ -0,0 +1,330 @@
+#include <benchmark/benchmark.h>
+#include <malloc.h>
+#include <sys/resource.h>
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <random>
+#include <ranges>
+#include <string>
+#include <vector>
+
+#include "deque.hpp"
+
+#if __has_include(<boost/container/devector.hpp>)
+#include <boost/container/devector.hpp>
+#define DEQUE_BENCHMARK_HAS_DEVECTOR
+#endif
+
+#ifndef DEQUE_BENCHMARK_MAX_BYTES
+#define DEQUE_BENCHMARK_MAX_BYTES (size_t{1} << 30)
+#endif
+
+struct AllocationCounters {
+  std::atomic<size_t> allocations{0};
+  std::atomic<size_t> live_bytes{0};
+  std::atomic<size_t> peak_bytes{0};
+};
+
+AllocationCounters allocation_counters;
+
+void* operator new(size_t size) {
+  void* pointer = std::malloc(size == 0 ? 1 : size);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  size_t usable_size = malloc_usable_size(pointer);
+  allocation_counters.allocations.fetch_add(1, std::memory_order_relaxed);
+  size_t live = allocation_counters.live_bytes.fetch_add(
+                    usable_size, std::memory_order_relaxed) +
+                usable_size;
+  size_t peak = allocation_counters.peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !allocation_counters.peak_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+  return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+  if (pointer == nullptr) {
+    return;
+  }
+  allocation_counters.live_bytes.fetch_sub(malloc_usable_size(pointer),
+                                           std::memory_order_relaxed);
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  operator delete(pointer);
+}
+
+template <size_t Bytes>
+struct Element {
+  std::array<unsigned char, Bytes> bytes{};
+};
+
+class Measurement {
+ public:
+  Measurement(benchmark::State& state, size_t operations_per_iteration);
+  ~Measurement();
+
+  template <typename Function>
+  void untimed(Function function);
+
+ private:
+  benchmark::State& state_;
+  size_t operations_per_iteration_;
+  size_t first_allocation_;
+  size_t untimed_allocations_ = 0;
+  size_t first_live_bytes_;
+};
+
+Measurement::Measurement(benchmark::State& state,
+                         size_t operations_per_iteration)
+    : state_(state),
+      operations_per_iteration_(operations_per_iteration),
+      first_allocation_(allocation_counters.allocations.load()),
+      first_live_bytes_(allocation_counters.live_bytes.load()) {
+  allocation_counters.peak_bytes.store(first_live_bytes_);
+}
+
+Measurement::~Measurement() {
+  size_t operations = state_.iterations() * operations_per_iteration_;
+  size_t allocations = allocation_counters.allocations.load() -
+                       first_allocation_ - untimed_allocations_;
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  state_.SetItemsProcessed(static_cast<int64_t>(operations));
+  state_.counters["allocs_per_op"] =
+      operations == 0 ? 0.0 : static_cast<double>(allocations) / operations;
+  state_.counters["peak_heap"] = benchmark::Counter(
+      static_cast<double>(allocation_counters.peak_bytes.load() -
+                          first_live_bytes_),
+      benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+  state_.counters["peak_rss"] = benchmark::Counter(
+      static_cast<double>(usage.ru_maxrss) * 1024,
+      benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+}
+
+template <typename Function>
+void Measurement::untimed(Function function) {
+  state_.PauseTiming();
+  size_t allocations = allocation_counters.allocations.load();
+  function();
+  untimed_allocations_ += allocation_counters.allocations.load() - allocations;
+  state_.ResumeTiming();
+}
+
+template <typename Container>
+concept FrontOperations = requires(Container& container) {
+  container.push_front(std::ranges::range_value_t<Container>{});
+  container.pop_front();
+};
+
+template <typename Container>
+void fill(Container& container, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    container.push_back(std::ranges::range_value_t<Container>{});
+  }
+}
+
+template <typename Container>
+void push_back_benchmark(benchmark::State& state) {
+  size_t count = state.range(0);
+  Measurement measurement(state, count);
+  for (auto _ : state) {
+    Container container;
+    fill(container, count);
+    benchmark::DoNotOptimize(container);
+  }
+}
+
+template <typename Container>
+void push_front_benchmark(benchmark::State& state) {
+  size_t count = state.range(0);
+  Measurement measurement(state, count);
+  for (auto _ : state) {
+    Container container;
+    for (size_t i = 0; i < count; ++i) {
+      container.push_front(std::ranges::range_value_t<Container>{});
+    }
+    benchmark::DoNotOptimize(container);
+  }
+}
+
+template <typename Container>
+void pop_back_benchmark(benchmark::State& state) {
+  size_t count = state.range(0);
+  Measurement measurement(state, count);
+  for (auto _ : state) {
+    Container container;
+    measurement.untimed([&] { fill(container, count); });
+    for (size_t i = 0; i < count; ++i) {
+      container.pop_back();
+    }
+    benchmark::DoNotOptimize(container);
+  }
+}
+
+template <typename Container>
+void pop_front_benchmark(benchmark::State& state) {
+  size_t count = state.range(0);
+  Measurement measurement(state, count);
+  for (auto _ : state) {
+    Container container;
+    measurement.untimed([&] { fill(container, count); });
+    for (size_t i = 0; i < count; ++i) {
+      container.pop_front();
+    }
+    benchmark::DoNotOptimize(container);
+  }
+}
+
+template <typename Container>
+void fifo_benchmark(benchmark::State& state) {
+  size_t count = state.range(0);
+  Container container;
+  fill(container, count);
+  Measurement measurement(state, count);
+  for (auto _ : state) {
+    for (size_t i = 0; i < count; ++i) {
+      container.push_back(std::ranges::range_value_t<Container>{});
+      container.pop_front();
+    }
+    benchmark::DoNotOptimize(container);
+  }
+}
+
+template <typename Container>
+void random_index_benchmark(benchmark::State& state) {
+  constexpr size_t kIndexCount = 1 << 16;
+  size_t count = state.range(0);
+  Container container;
+  fill(container, count);
+  std::mt19937_64 generator(count);
+  std::uniform_int_distribution<size_t> distribution(0, count - 1);
+  std::vector<size_t> indices(kIndexCount);
+  for (size_t& index : indices) {
+    index = distribution(generator);
+  }
+  Measurement measurement(state, kIndexCount);
+  for (auto _ : state) {
+    unsigned sum = 0;
+    for (size_t index : indices) {
+      sum += container[index].bytes[0];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+template <typename Container>
+void iteration_benchmark(benchmark::State& state) {
+  size_t count = state.range(0);
+  Container container;
+  fill(container, count);
+  Measurement measurement(state, count);
+  for (auto _ : state) {
+    unsigned sum = 0;
+    for (const auto& element : container) {
+      sum += element.bytes[0];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+
+template <typename Container>
+void middle_insert_erase_benchmark(benchmark::State& state) {
+  size_t count = state.range(0);
+  Container container;
+  fill(container, count);
+  Measurement measurement(state, 1);
+  for (auto _ : state) {
+    container.insert(container.begin() + count / 2,
+                     std::ranges::range_value_t<Container>{});
+    container.erase(container.begin() + count / 2);
+    benchmark::DoNotOptimize(container);
+  }
+}
+
+template <typename Container>
+void copy_construction_benchmark(benchmark::State& state) {
+  size_t count = state.range(0);
+  Container source;
+  fill(source, count);
+  Measurement measurement(state, count);
+  for (auto _ : state) {
+    Container copy(source);
+    benchmark::DoNotOptimize(copy);
+  }
+}
+
+template <typename Container>
+void copy_assignment_benchmark(benchmark::State& state) {
+  size_t count = state.range(0);
+  Container source;
+  fill(source, count);
+  Container target;
+  fill(target, count);
+  Measurement measurement(state, count);
+  for (auto _ : state) {
+    target = source;
+    benchmark::DoNotOptimize(target);
+  }
+}
+
+template <typename Container>
+void register_container(const std::string& container_name) {
+  using value_type = std::ranges::range_value_t<Container>;
+  std::string suffix = "<" + container_name + ", " +
+                       std::to_string(sizeof(value_type)) + ">";
+  auto add = [&](const std::string& name,
+                 void (*function)(benchmark::State&)) {
+    benchmark::internal::Benchmark* registered =
+        benchmark::RegisterBenchmark((name + suffix).c_str(), function);
+    for (size_t count = 100; count <= 100'000'000; count *= 100) {
+      if (count * sizeof(value_type) <= DEQUE_BENCHMARK_MAX_BYTES) {
+        registered->Arg(static_cast<int64_t>(count));
+      }
+    }
+  };
+  add("push_back", push_back_benchmark<Container>);
+  add("pop_back", pop_back_benchmark<Container>);
+  if constexpr (FrontOperations<Container>) {
+    add("push_front", push_front_benchmark<Container>);
+    add("pop_front", pop_front_benchmark<Container>);
+    add("fifo", fifo_benchmark<Container>);
+  }
+  add("random_index", random_index_benchmark<Container>);
+  add("iteration", iteration_benchmark<Container>);
+  add("middle_insert_erase", middle_insert_erase_benchmark<Container>);
+  add("copy_construction", copy_construction_benchmark<Container>);
+  add("copy_assignment", copy_assignment_benchmark<Container>);
+}
+
+template <size_t Bytes>
+void register_element_size() {
+  register_container<Deque<Element<Bytes>>>("Deque");
+  register_container<std::deque<Element<Bytes>>>("std::deque");
+  register_container<std::vector<Element<Bytes>>>("std::vector");
+#ifdef DEQUE_BENCHMARK_HAS_DEVECTOR
+  register_container<boost::container::devector<Element<Bytes>>>(
+      "boost::devector");
+#endif
+}
+
+int main(int argc, char** argv) {
+  register_element_size<1>();
+  register_element_size<8>();
+  register_element_size<64>();
+  register_element_size<512>();
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
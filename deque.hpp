@@ -1,11 +1,96 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <ranges>
+#include <span>
+
+template <typename T, size_t TargetBytes = 4096, size_t SpareBuckets = 2>
+struct DefaultBucketPolicy {
+  static constexpr size_t kBucketSize =
+      std::bit_floor(std::max<size_t>(TargetBytes / sizeof(T), 1));
+  static constexpr size_t kSpareBuckets = SpareBuckets;
+};
+
+template <size_t Elements, size_t SpareBuckets = 2>
+struct FixedBucketPolicy {
+  static constexpr size_t kBucketSize = std::bit_ceil(Elements);
+  static constexpr size_t kSpareBuckets = SpareBuckets;
+};
+
+template <typename BucketPolicy, size_t InlineElements>
+struct InlineStoragePolicy : BucketPolicy {
+  static constexpr size_t kInlineElements = InlineElements;
+};
+
+template <typename BucketPolicy>
+concept HasInlineStorage = BucketPolicy::kInlineElements > 0;
+
+template <typename BucketPolicy, size_t MigrationSlots = 32>
+struct IncrementalGrowthPolicy : BucketPolicy {
+  static constexpr size_t kMigrationSlots = MigrationSlots;
+};
+
+template <typename BucketPolicy>
+concept GrowsIncrementally = BucketPolicy::kMigrationSlots > 0;
+
+template <typename BucketPolicy>
+struct StatsBucketPolicy : BucketPolicy {
+  static constexpr bool kCollectStats = true;
+};
+
+template <typename BucketPolicy>
+concept CollectsStats = BucketPolicy::kCollectStats;
+
+template <typename BucketPolicy>
+struct StableHandlePolicy : BucketPolicy {
+  static constexpr bool kStableHandles = true;
+};
+
+template <typename BucketPolicy>
+concept HasStableHandles = BucketPolicy::kStableHandles;
+
+struct DequeStats {
+  size_t reallocations = 0;
+  size_t bytes_moved = 0;
+  size_t bucket_allocations = 0;
+  size_t bucket_deallocations = 0;
+  size_t peak_size = 0;
+  size_t peak_container_capacity = 0;
+  size_t wasted_slots = 0;
+  std::chrono::nanoseconds growth_time{0};
+};
+
+struct DequeHandle {
+  size_t sequence = 0;
+  size_t generation = 0;
+
+  bool operator==(const DequeHandle& other) const = default;
+};
 
-template <typename T, typename Allocator = std::allocator<T>>
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename Allocator, typename T>
+concept CustomizesConstruction =
+    requires(Allocator& allocator, T* pointer, T&& value) {
+      allocator.construct(pointer, std::move(value));
+    } || requires(Allocator& allocator, T* pointer) {
+      allocator.destroy(pointer);
+    };
+
+template <typename T, typename Allocator = std::allocator<T>,
+          typename BucketPolicy = DefaultBucketPolicy<T>>
 class Deque {
  public:
-  Deque() = default;
+  Deque() : Deque(Allocator()) {}
   Deque(const Allocator& allocator);
   Deque(const Deque& other);
   Deque(size_t count, const Allocator& alloc = Allocator());
@@ -14,20 +99,27 @@ class Deque {
   Deque(Deque&& other);
   Deque(std::initializer_list<T> init, const Allocator& alloc = Allocator());
   ~Deque();
-  Deque<T, Allocator>& operator=(const Deque& other);
-  Deque<T, Allocator>& operator=(Deque&& other);
+  Deque<T, Allocator, BucketPolicy>& operator=(const Deque& other);
+  Deque<T, Allocator, BucketPolicy>& operator=(Deque&& other);
   size_t size() const;
   bool empty() const;
   T& operator[](size_t ind);
   const T& operator[](size_t ind) const;
   T& at(size_t ind);
   const T& at(size_t ind) const;
+  template <std::ranges::random_access_range Indices, typename OutputIt>
+    requires std::ranges::sized_range<const Indices>
+  OutputIt gather(const Indices& indices, OutputIt out) const;
   void push_back(T&& value);
   void push_back(const T& value);
   void pop_back();
+  void pop_back(size_t count);
   void push_front(T&& value);
   void push_front(const T& value);
   void pop_front();
+  void pop_front(size_t count);
+  template <typename OutputIt>
+  OutputIt drain_front(size_t count, OutputIt out);
   template <typename... Arguments>
   void emplace_back(Arguments&&... args);
   template <typename... Arguments>
@@ -50,9 +142,37 @@ class Deque {
   const_reverse_iterator crbegin() const;
   const_reverse_iterator crend() const;
 
-  void insert(iterator iter, const T& value);
-  void erase(iterator iter);
-  void emplace(iterator iter, T&& value);
+  iterator insert(iterator iter, const T& value);
+  iterator insert(iterator iter, T&& value);
+  iterator insert(iterator iter, size_t count, const T& value);
+  template <std::input_iterator InputIt>
+  iterator insert(iterator iter, InputIt first, InputIt last);
+  iterator insert(iterator iter, std::initializer_list<T> init);
+  iterator erase(iterator iter);
+  iterator erase(iterator first, iterator last);
+  template <typename... Arguments>
+  iterator emplace(iterator iter, Arguments&&... args);
+  template <std::ranges::input_range Range>
+  void append_range(Range&& range);
+  template <std::ranges::input_range Range>
+  void prepend_range(Range&& range);
+  template <typename Function>
+  void append_segments(size_t count, Function function);
+  template <typename Function>
+  void prepend_segments(size_t count, Function function);
+
+  void reserve_back(size_t count);
+  void reserve_front(size_t count);
+  void shrink_to_fit();
+  void swap(Deque& other);
+
+  size_t segment_count() const;
+  std::span<T> segment(size_t index);
+  std::span<const T> segment(size_t index) const;
+  template <typename Function>
+  void for_each_segment(Function function);
+  template <typename Function>
+  void for_each_segment(Function function) const;
 
   using allocator_type = Allocator;
   using allocator_traits = std::allocator_traits<allocator_type>;
@@ -63,540 +183,1415 @@ class Deque {
 
   allocator_type get_allocator() const { return alloc_; }
 
+  DequeStats stats() const
+    requires CollectsStats<BucketPolicy>;
+  void set_growth_callback(std::function<void(const DequeStats&)> callback)
+    requires CollectsStats<BucketPolicy>;
+
+  DequeHandle handle(size_t index) const
+    requires HasStableHandles<BucketPolicy>;
+  T* resolve(DequeHandle handle)
+    requires HasStableHandles<BucketPolicy>;
+  const T* resolve(DequeHandle handle) const
+    requires HasStableHandles<BucketPolicy>;
+
  private:
-  void clear(size_t cur_bucket);
-  void reallocation();
-  void swap(Deque& other);
+  struct StatsState {
+    DequeStats stats;
+    std::function<void(const DequeStats&)> growth_callback;
+  };
+  struct NoStatsState {};
+
+  struct HandleRange {
+    size_t first = 0;
+    size_t last = 0;
+    size_t generation = 0;
+    bool open = false;
+  };
+  struct HandleState {
+    size_t sequence_base = 0;
+    size_t generation = 0;
+    size_t valid_generation = 0;
+    size_t front_low = 0;
+    size_t back_high = 0;
+    HandleRange front_reused;
+    HandleRange back_reused;
+  };
+  struct NoHandleState {};
+
+  void reallocation(bool at_front, size_t extra_buckets = 1);
+  std::chrono::steady_clock::time_point growth_started() const;
+  void growth_finished(std::chrono::steady_clock::time_point started,
+                       size_t bytes_moved);
+  void record_size();
+  size_t front_offset() const;
+  size_t handle_index(DequeHandle handle) const;
+  void rebase_handles(size_t previous_front_offset);
+  void invalidate_handles();
+  void track_front_push(size_t count);
+  void track_back_push(size_t count);
+  void track_pop(bool at_front);
+  bool reused_since(const HandleRange& range, DequeHandle handle,
+                    size_t index) const;
+  static void prefetch(const void* address, size_t bytes);
+  bool uses_inline_storage() const;
+  size_t inline_room(bool at_front) const;
+  bool moves_inline_elements(size_t count) const;
+  void prepare_inline_storage(bool at_front, size_t count);
+  void spill_inline_storage();
+  void relocate_elements(T* source, size_t count, T* destination);
+  T* new_bucket();
+  void delete_bucket(T* bucket);
+  T** allocate_container_storage(size_t capacity);
+  T** allocate_container(size_t capacity);
+  void deallocate_container(T** container, size_t capacity);
+  size_t front_limit() const;
+  size_t back_limit() const;
+  void migration_step();
+  void start_migration();
+  void advance_migration(size_t slots);
+  void finish_migration();
+  void cancel_migration();
+  void allocate_bucket(size_t bucket);
+  void release_bucket(size_t bucket);
+  void release_spare_buckets();
+  void release_storage();
+  void steal_storage(Deque& other);
+  void adopt_inline_storage(Deque& other);
+  void reset_empty_position();
+  template <bool Move, typename Other>
+  void assign_elements(Other& other);
+  size_t contiguous_elements(size_t index) const;
+  template <bool Relocate = false>
+  void move_elements(size_t source, size_t count, size_t destination);
+  void destroy_elements(size_t index, size_t count);
+  void discard_front(size_t count);
+  void discard_back(size_t count);
+  template <typename InputIt>
+  InputIt construct_range(T* destination, size_t count, InputIt first);
+  template <typename... Arguments>
+  void construct_fill(T* destination, size_t count, const Arguments&... args);
+  template <typename Constructor>
+  void append_elements(size_t count, Constructor construct);
+  template <typename Constructor>
+  void prepend_elements(size_t count, Constructor construct);
+  template <typename Constructor>
+  iterator insert_elements(iterator iter, size_t count, Constructor construct);
   size_t container_capacity_ = 0;
   size_t size_ = 0;
   T** container_ = nullptr;
   size_t first_element_bucket_ = 0;
-  size_t first_element_position_ = 2;
+  size_t first_element_position_ = kInitialPosition;
   size_t last_element_bucket_ = 0;
-  size_t last_element_position_ = 2;
-  static const short int kBucketSize = 32;
+  size_t last_element_position_ = kInitialPosition;
+  static constexpr size_t kBucketSize = BucketPolicy::kBucketSize;
+  static constexpr size_t kBucketShift = std::countr_zero(kBucketSize);
+  static constexpr size_t kBucketMask = kBucketSize - 1;
+  static_assert(std::has_single_bit(kBucketSize),
+                "bucket size must be a power of two");
+  static constexpr bool kDefaultAllocator =
+      !CustomizesConstruction<allocator_type, T>;
+  static constexpr bool kTriviallyCopyable =
+      kDefaultAllocator && std::is_trivially_copyable_v<T>;
+  static constexpr bool kTriviallyDestructible =
+      kDefaultAllocator && std::is_trivially_destructible_v<T>;
+  static constexpr bool kTriviallyRelocatable =
+      kDefaultAllocator && IsTriviallyRelocatable<T>::value;
+  static constexpr bool kCollectStats = CollectsStats<BucketPolicy>;
+  static constexpr bool kInlineStorage = HasInlineStorage<BucketPolicy>;
+  static constexpr bool kIncrementalGrowth = GrowsIncrementally<BucketPolicy>;
+  static constexpr bool kStableHandles = HasStableHandles<BucketPolicy>;
+  static constexpr size_t kInitialPosition = kBucketSize / 2;
+  static constexpr size_t kCacheLineBytes = 64;
+  static constexpr size_t kPrefetchBytes =
+      std::min<size_t>(kBucketSize * sizeof(T), 2 * kCacheLineBytes);
+  static constexpr size_t kGatherDistance = 16;
+  static constexpr size_t kInlineElements = [] {
+    if constexpr (kInlineStorage) {
+      return BucketPolicy::kInlineElements;
+    } else {
+      return size_t{1};
+    }
+  }();
+  static_assert(!kInlineStorage || kInlineElements < kBucketSize,
+                "inline storage must be smaller than a bucket");
+  static_assert(!kInlineStorage || std::is_nothrow_move_constructible_v<T>,
+                "inline elements are relocated when a deque is moved");
+
+  struct InlineStorage {
+    alignas(T) unsigned char elements[kInlineElements * sizeof(T)];
+    T* container[2];
+  };
+  struct NoInlineStorage {};
+
+  struct MigrationState {
+    T** container = nullptr;
+    size_t capacity = 0;
+    std::ptrdiff_t offset = 0;
+    size_t window_first = 0;
+    size_t window_last = 0;
+    size_t copied = 0;
+    size_t released = 0;
+  };
+  struct NoMigrationState {};
+
+  std::array<T*, BucketPolicy::kSpareBuckets> spare_buckets_{};
+  size_t spare_bucket_count_ = 0;
 
   allocator_type alloc_;
   container_allocator container_alloc_;
+  [[no_unique_address]] std::conditional_t<kCollectStats, StatsState,
+                                           NoStatsState> stats_;
+  [[no_unique_address]] std::conditional_t<kInlineStorage, InlineStorage,
+                                           NoInlineStorage> inline_;
+  [[no_unique_address]] std::conditional_t<
+      kIncrementalGrowth, MigrationState, NoMigrationState> migration_;
+  [[no_unique_address]] std::conditional_t<kStableHandles, HandleState,
+                                           NoHandleState> handles_;
 };
 
-template <typename T, typename Allocator>
-Deque<T, Allocator>::Deque(const Allocator& allocator)
+template <typename T, size_t InlineElements,
+          typename Allocator = std::allocator<T>>
+using SmallDeque = Deque<
+    T, Allocator, InlineStoragePolicy<DefaultBucketPolicy<T>, InlineElements>>;
+
+template <typename T, typename Allocator, typename BucketPolicy>
+Deque<T, Allocator, BucketPolicy>::Deque(const Allocator& allocator)
     : alloc_(allocator), container_alloc_(allocator) {}
 
-template <typename T, typename Allocator>
-void Deque<T, Allocator>::clear(size_t cur_bucket) {
-  for (size_t i = 0; i < cur_bucket; ++i) {
-    for (size_t j = 0; j < kBucketSize; ++j) {
-      allocator_traits::destroy(alloc_, container_[i] + j);
-    }
-    allocator_traits::deallocate(alloc_, container_[i] + kBucketSize,
-                                 kBucketSize);
-  }
-  container_allocator_traits::deallocate(container_alloc_, container_,
-                                         container_capacity_);
-}
-
-template <typename T, typename Allocator>
-Deque<T, Allocator>::Deque(const Deque& other)
-    : size_(other.size_),
-      alloc_(allocator_traits::select_on_container_copy_construction(
-          other.alloc_)),
-      container_alloc_(
-          container_allocator_traits::select_on_container_copy_construction(
-              other.container_alloc_)),
-      container_capacity_((other.size_ - 1) / kBucketSize + 1) {
-  if (other.container_ != nullptr) {
-    container_ = container_allocator_traits::allocate(container_alloc_,
-                                                      container_capacity_);
-    size_t cur_bucket = 0;
-    auto element = other.cbegin();
-    try {
-      for (; cur_bucket < container_capacity_; ++cur_bucket) {
-        container_allocator_traits::construct(
-            container_alloc_, container_ + cur_bucket,
-            std::allocator_traits<allocator_type>::allocate(alloc_,
-                                                            kBucketSize));
-        int finish = cur_bucket == container_capacity_ - 1
-                         ? (size_ - 1) % kBucketSize + 1
-                         : kBucketSize;
-        int position = 0;
-        try {
-          for (; position < finish; ++position) {
-            allocator_traits::construct(
-                alloc_, container_[cur_bucket] + position, *element);
-            ++element;
-          }
-        } catch (...) {
-          for (int i = 0; i < position; ++i) {
-            allocator_traits::destroy(alloc_, container_[cur_bucket] + i);
-          }
-          allocator_traits::deallocate(alloc_, container_[cur_bucket],
-                                       kBucketSize);
-          throw;
-        }
-      }
-    } catch (...) {
-      clear(cur_bucket);
-      throw;
-    }
-    last_element_position_ = (size_ - 1) % kBucketSize;
-    last_element_bucket_ = container_capacity_ - 1;
-    first_element_bucket_ = 0;
-    first_element_position_ = 0;
-  }
+template <typename T, typename Allocator, typename BucketPolicy>
+Deque<T, Allocator, BucketPolicy>::Deque(const Deque& other)
+    : Deque(allocator_traits::select_on_container_copy_construction(
+          other.alloc_)) {
+  first_element_position_ = other.first_element_position_;
+  last_element_position_ = other.first_element_position_;
+  assign_elements<false>(other);
 }
 
-template <typename T, typename Allocator>
-Deque<T, Allocator>::Deque(size_t count, const Allocator& alloc)
-    : size_(count),
-      container_capacity_((count - 1) / kBucketSize + 1),
-      alloc_(alloc),
-      container_alloc_(alloc) {
-  container_ = container_allocator_traits::allocate(container_alloc_,
-                                                    container_capacity_);
-  size_t cur_bucket = 0;
-  try {
-    for (; cur_bucket < container_capacity_; ++cur_bucket) {
-      container_allocator_traits::construct(
-          container_alloc_, container_ + cur_bucket,
-          std::allocator_traits<allocator_type>::allocate(alloc_, kBucketSize));
-      int finish = cur_bucket == container_capacity_ - 1
-                       ? (size_ - 1) % kBucketSize + 1
-                       : kBucketSize;
-      int position = 0;
-      try {
-        for (; position < finish; ++position) {
-          allocator_traits::construct(alloc_,
-                                      container_[cur_bucket] + position);
-        }
-      } catch (...) {
-        for (int i = 0; i < position; ++i) {
-          allocator_traits::destroy(alloc_, container_[cur_bucket] + i);
-        }
-        allocator_traits::deallocate(alloc_, container_[cur_bucket],
-                                     kBucketSize);
-        throw;
-      }
-    }
-  } catch (...) {
-    clear(cur_bucket);
-    throw;
-  }
-  last_element_position_ = (count - 1) % kBucketSize;
-  last_element_bucket_ = container_capacity_ - 1;
-  first_element_bucket_ = 0;
+template <typename T, typename Allocator, typename BucketPolicy>
+Deque<T, Allocator, BucketPolicy>::Deque(size_t count, const Allocator& alloc)
+    : Deque(alloc) {
   first_element_position_ = 0;
+  last_element_position_ = 0;
+  append_elements(count, [&](T* destination, size_t length) {
+    construct_fill(destination, length);
+  });
 }
 
-template <typename T, typename Allocator>
-Deque<T, Allocator>::Deque(size_t count, const T& value, const Allocator& alloc)
-    : size_(count),
-      container_capacity_((count - 1) / kBucketSize + 1),
-      alloc_(alloc),
-      container_alloc_(alloc) {
-  container_ = container_allocator_traits::allocate(container_alloc_,
-                                                    container_capacity_);
-  size_t cur_bucket = 0;
-  try {
-    for (; cur_bucket < container_capacity_; ++cur_bucket) {
-      container_allocator_traits::construct(
-          container_alloc_, container_ + cur_bucket,
-          std::allocator_traits<allocator_type>::allocate(alloc_, kBucketSize));
-      int finish = cur_bucket == container_capacity_ - 1
-                       ? (size_ - 1) % kBucketSize + 1
-                       : kBucketSize;
-      int position = 0;
-      try {
-        for (; position < finish; ++position) {
-          allocator_traits::construct(alloc_, container_[cur_bucket] + position,
-                                      value);
-        }
-      } catch (...) {
-        for (int i = 0; i < position; ++i) {
-          allocator_traits::destroy(alloc_, container_[cur_bucket] + i);
-        }
-        allocator_traits::deallocate(alloc_, container_[cur_bucket],
-                                     kBucketSize);
-        throw;
+template <typename T, typename Allocator, typename BucketPolicy>
+Deque<T, Allocator, BucketPolicy>::Deque(size_t count, const T& value,
+                                         const Allocator& alloc)
+    : Deque(alloc) {
+  first_element_position_ = 0;
+  last_element_position_ = 0;
+  append_elements(count, [&](T* destination, size_t length) {
+    construct_fill(destination, length, value);
+  });
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+Deque<T, Allocator, BucketPolicy>::Deque(Deque&& other) : Deque(other.alloc_) {
+  steal_storage(other);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+Deque<T, Allocator, BucketPolicy>::Deque(std::initializer_list<T> init,
+                                         const Allocator& alloc)
+    : Deque(alloc) {
+  first_element_position_ = 0;
+  last_element_position_ = 0;
+  auto element = init.begin();
+  append_elements(init.size(), [&](T* destination, size_t length) {
+    element = construct_range(destination, length, element);
+  });
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+Deque<T, Allocator, BucketPolicy>::~Deque() {
+  release_storage();
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::release_storage() {
+  cancel_migration();
+  invalidate_handles();
+  if (container_ != nullptr) {
+    destroy_elements(0, size_);
+    for (size_t i = 0; i < container_capacity_; ++i) {
+      if (container_[i] != nullptr) {
+        delete_bucket(container_[i]);
       }
     }
-  } catch (...) {
-    clear(cur_bucket);
-    throw;
+    deallocate_container(container_, container_capacity_);
   }
-  last_element_position_ = (count - 1) % kBucketSize;
-  last_element_bucket_ = container_capacity_ - 1;
+  release_spare_buckets();
+  container_ = nullptr;
+  container_capacity_ = 0;
+  size_ = 0;
   first_element_bucket_ = 0;
-  first_element_position_ = 0;
+  first_element_position_ = kInitialPosition;
+  last_element_bucket_ = 0;
+  last_element_position_ = kInitialPosition;
 }
 
-template <typename T, typename Allocator>
-Deque<T, Allocator>::Deque(Deque&& other)
-    : container_(other.container_),
-      alloc_(other.alloc_),
-      container_alloc_(other.container_alloc_),
-      container_capacity_(other.container_capacity_),
-      size_(other.size_),
-      first_element_bucket_(other.first_element_bucket_),
-      first_element_position_(other.first_element_position_),
-      last_element_bucket_(other.last_element_bucket_),
-      last_element_position_(other.last_element_position_) {
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::steal_storage(Deque& other) {
+  other.cancel_migration();
+  container_ = other.container_;
+  container_capacity_ = other.container_capacity_;
+  size_ = other.size_;
+  first_element_bucket_ = other.first_element_bucket_;
+  first_element_position_ = other.first_element_position_;
+  last_element_bucket_ = other.last_element_bucket_;
+  last_element_position_ = other.last_element_position_;
+  spare_buckets_ = other.spare_buckets_;
+  spare_bucket_count_ = other.spare_bucket_count_;
   other.container_ = nullptr;
   other.container_capacity_ = 0;
   other.size_ = 0;
   other.first_element_bucket_ = 0;
-  other.first_element_position_ = 0;
+  other.first_element_position_ = kInitialPosition;
   other.last_element_bucket_ = 0;
-  other.last_element_position_ = 0;
-}
-
-template <typename T, typename Allocator>
-Deque<T, Allocator>::Deque(std::initializer_list<T> init,
-                           const Allocator& alloc)
-    : size_(init.size()),
-      container_capacity_((init.size() - 1) / kBucketSize + 1),
-      alloc_(alloc),
-      container_alloc_(alloc) {
-  container_ = container_allocator_traits::allocate(container_alloc_,
-                                                    container_capacity_);
-  size_t cur_bucket = 0;
-  auto value = init.begin();
-  try {
-    for (; cur_bucket < container_capacity_; ++cur_bucket) {
-      container_allocator_traits::construct(
-          container_alloc_, container_ + cur_bucket,
-          allocator_traits::allocate(alloc_, kBucketSize));
-      size_t border = cur_bucket == container_capacity_ - 1
-                          ? (size_ - 1) % kBucketSize + 1
-                          : kBucketSize;
-      size_t position = 0;
-      try {
-        for (; position < border; ++position) {
-          allocator_traits::construct(alloc_, container_[cur_bucket] + position,
-                                      *value);
-          ++value;
-        }
-      } catch (...) {
-        for (size_t i = 0; i < position; ++i) {
-          allocator_traits::destroy(alloc_, container_[cur_bucket] + i);
-        }
-        allocator_traits::deallocate(alloc_, container_[cur_bucket],
-                                     kBucketSize);
-        throw;
-      }
-    }
-  } catch (...) {
-    clear(cur_bucket);
-    throw;
+  other.last_element_position_ = kInitialPosition;
+  other.spare_bucket_count_ = 0;
+  if constexpr (kInlineStorage) {
+    adopt_inline_storage(other);
   }
-  last_element_position_ = (size_ - 1) % kBucketSize;
-  last_element_bucket_ = container_capacity_ - 1;
-  first_element_bucket_ = 0;
-  first_element_position_ = 0;
+  invalidate_handles();
+  other.invalidate_handles();
+  record_size();
 }
 
-template <typename T, typename Allocator>
-Deque<T, Allocator>::~Deque() {
-  if (container_ != nullptr) {
-    for (size_t i = 0; i < first_element_bucket_; ++i) {
-      allocator_traits::deallocate(alloc_, container_[i], kBucketSize);
-    }
-    for (size_t i = first_element_bucket_; i <= last_element_bucket_; ++i) {
-      int start = i == first_element_bucket_ ? first_element_position_ : 0;
-      int finish =
-          i == last_element_bucket_ ? last_element_position_ + 1 : kBucketSize;
-      for (; start < finish; ++start) {
-        allocator_traits::destroy(alloc_, container_[i] + start);
-      }
-      allocator_traits::deallocate(alloc_, container_[i], kBucketSize);
-    }
-    for (size_t i = last_element_bucket_ + 1; i < container_capacity_; ++i) {
-      allocator_traits::deallocate(alloc_, container_[i], kBucketSize);
-    }
-    container_allocator_traits::deallocate(container_alloc_, container_,
-                                           container_capacity_);
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::adopt_inline_storage(Deque& other) {
+  if (container_ != other.inline_.container) {
+    return;
+  }
+  inline_.container[0] = reinterpret_cast<T*>(inline_.elements);
+  inline_.container[1] = nullptr;
+  container_ = inline_.container;
+  if (!empty()) {
+    relocate_elements(other.inline_.container[0] + first_element_position_,
+                      size_, container_[0] + first_element_position_);
   }
 }
 
-template <typename T, typename Allocator>
-void Deque<T, Allocator>::swap(Deque& other) {
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::reset_empty_position() {
+  if (!empty()) {
+    return;
+  }
+  if (uses_inline_storage()) {
+    first_element_position_ = 0;
+    last_element_position_ = 0;
+  }
+  invalidate_handles();
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::swap(Deque& other) {
+  if constexpr (kInlineStorage) {
+    Deque temporary(std::move(other));
+    other = std::move(*this);
+    *this = std::move(temporary);
+    return;
+  }
+  if constexpr (allocator_traits::propagate_on_container_swap::value) {
+    std::swap(alloc_, other.alloc_);
+    std::swap(container_alloc_, other.container_alloc_);
+  }
+  cancel_migration();
+  other.cancel_migration();
+  std::swap(container_, other.container_);
   std::swap(container_capacity_, other.container_capacity_);
   std::swap(size_, other.size_);
-  std::swap(container_, other.container_);
   std::swap(first_element_bucket_, other.first_element_bucket_);
   std::swap(first_element_position_, other.first_element_position_);
   std::swap(last_element_bucket_, other.last_element_bucket_);
   std::swap(last_element_position_, other.last_element_position_);
-  std::swap(alloc_, other.alloc_);
-  std::swap(container_alloc_, other.container_alloc_);
+  std::swap(spare_buckets_, other.spare_buckets_);
+  std::swap(spare_bucket_count_, other.spare_bucket_count_);
+  invalidate_handles();
+  other.invalidate_handles();
+  record_size();
+  other.record_size();
 }
 
-template <typename T, typename Allocator>
-Deque<T, Allocator>& Deque<T, Allocator>::operator=(const Deque& other) {
-  if (this != &other) {
-    allocator_type next_allocator = alloc_;
-    allocator_type old_allocator = alloc_;
-    size_t old_size = size_;
-    if (std::allocator_traits<
-            allocator_type>::propagate_on_container_copy_assignment::value) {
-      next_allocator = other.alloc_;
+template <typename T, typename Allocator, typename BucketPolicy>
+void swap(Deque<T, Allocator, BucketPolicy>& first,
+          Deque<T, Allocator, BucketPolicy>& second) {
+  first.swap(second);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+Deque<T, Allocator, BucketPolicy>& Deque<T, Allocator, BucketPolicy>::operator=(
+    const Deque& other) {
+  if (this == &other) {
+    return *this;
+  }
+  if constexpr (allocator_traits::propagate_on_container_copy_assignment::
+                    value) {
+    if (alloc_ != other.alloc_) {
+      release_storage();
+    }
+    alloc_ = other.alloc_;
+    container_alloc_ = other.container_alloc_;
+  }
+  assign_elements<false>(other);
+  return *this;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+Deque<T, Allocator, BucketPolicy>& Deque<T, Allocator, BucketPolicy>::operator=(
+    Deque&& other) {
+  if (this == &other) {
+    return *this;
+  }
+  if (allocator_traits::propagate_on_container_move_assignment::value ||
+      alloc_ == other.alloc_) {
+    release_storage();
+    if constexpr (allocator_traits::propagate_on_container_move_assignment::
+                      value) {
+      alloc_ = other.alloc_;
+      container_alloc_ = other.container_alloc_;
+    }
+    steal_storage(other);
+  } else {
+    assign_elements<true>(other);
+    other.destroy_elements(0, other.size_);
+    other.discard_back(other.size_);
+  }
+  return *this;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool Move, typename Other>
+void Deque<T, Allocator, BucketPolicy>::assign_elements(Other& other) {
+  invalidate_handles();
+  size_t common = std::min(size_, other.size_);
+  for (size_t index = 0; index < common;) {
+    size_t chunk = std::min({common - index, contiguous_elements(index),
+                             other.contiguous_elements(index)});
+    auto source = &other[index];
+    if constexpr (Move) {
+      std::move(source, source + chunk, &(*this)[index]);
+    } else {
+      std::copy(source, source + chunk, &(*this)[index]);
     }
-    size_t cur_index = 0;
-    auto other_element = other.cbegin();
+    index += chunk;
+  }
+  if (other.size_ < size_) {
+    destroy_elements(other.size_, size_ - other.size_);
+    discard_back(size_ - other.size_);
+    return;
+  }
+  size_t index = size_;
+  append_elements(other.size_ - size_, [&](T* destination, size_t length) {
+    T* first = destination;
     try {
-      alloc_ = next_allocator;
-      for (; cur_index < other.size_; ++cur_index) {
-        push_back(*other_element);
-        ++other_element;
+      while (length != 0) {
+        size_t chunk = std::min(length, other.contiguous_elements(index));
+        if constexpr (Move) {
+          construct_range(destination, chunk,
+                          std::make_move_iterator(&other[index]));
+        } else {
+          construct_range(destination, chunk, &other[index]);
+        }
+        destination += chunk;
+        index += chunk;
+        length -= chunk;
       }
     } catch (...) {
-      for (size_t i = 0; i < cur_index - 1; ++i) {
-        pop_back();
+      for (; first != destination; ++first) {
+        allocator_traits::destroy(alloc_, first);
       }
-      alloc_ = old_allocator;
       throw;
     }
-    alloc_ = old_allocator;
-    for (size_t i = 0; i < old_size; ++i) {
-      pop_front();
-    }
-    alloc_ = next_allocator;
-  }
-  return *this;
+  });
 }
 
-template <typename T, typename Allocator>
-Deque<T, Allocator>& Deque<T, Allocator>::operator=(Deque&& other) {
-  swap(other);
-  return *this;
+template <typename T, typename Allocator, typename BucketPolicy>
+size_t Deque<T, Allocator, BucketPolicy>::contiguous_elements(
+    size_t index) const {
+  return kBucketSize - ((first_element_position_ + index) & kBucketMask);
 }
 
-template <typename T, typename Allocator>
-size_t Deque<T, Allocator>::size() const {
+template <typename T, typename Allocator, typename BucketPolicy>
+size_t Deque<T, Allocator, BucketPolicy>::size() const {
   return size_;
 }
 
-template <typename T, typename Allocator>
-bool Deque<T, Allocator>::empty() const {
+template <typename T, typename Allocator, typename BucketPolicy>
+bool Deque<T, Allocator, BucketPolicy>::empty() const {
   return size_ == 0;
 }
 
-template <typename T, typename Allocator>
-T& Deque<T, Allocator>::operator[](size_t ind) {
-  if (ind <= kBucketSize - first_element_position_ - 1) {
-    return container_[first_element_bucket_][first_element_position_ + ind];
+template <typename T, typename Allocator, typename BucketPolicy>
+size_t Deque<T, Allocator, BucketPolicy>::segment_count() const {
+  return empty() ? 0 : last_element_bucket_ - first_element_bucket_ + 1;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+std::span<T> Deque<T, Allocator, BucketPolicy>::segment(size_t index) {
+  size_t bucket = first_element_bucket_ + index;
+  size_t start = index == 0 ? first_element_position_ : 0;
+  size_t finish =
+      bucket == last_element_bucket_ ? last_element_position_ + 1 : kBucketSize;
+  return std::span<T>(container_[bucket] + start, finish - start);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+std::span<const T> Deque<T, Allocator, BucketPolicy>::segment(
+    size_t index) const {
+  size_t bucket = first_element_bucket_ + index;
+  size_t start = index == 0 ? first_element_position_ : 0;
+  size_t finish =
+      bucket == last_element_bucket_ ? last_element_position_ + 1 : kBucketSize;
+  return std::span<const T>(container_[bucket] + start, finish - start);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename Function>
+void Deque<T, Allocator, BucketPolicy>::for_each_segment(Function function) {
+  for (size_t i = 0, count = segment_count(); i < count; ++i) {
+    if (i + 1 < count) {
+      prefetch(container_[first_element_bucket_ + i + 1], kPrefetchBytes);
+    }
+    function(segment(i));
   }
-  ind -= kBucketSize - first_element_position_;
-  return container_[first_element_bucket_ + 1 + ind / kBucketSize]
-                   [ind % kBucketSize];
 }
 
-template <typename T, typename Allocator>
-const T& Deque<T, Allocator>::operator[](size_t ind) const {
-  if (ind <= kBucketSize - first_element_position_ - 1) {
-    return container_[first_element_bucket_][first_element_position_ + ind];
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename Function>
+void Deque<T, Allocator, BucketPolicy>::for_each_segment(
+    Function function) const {
+  for (size_t i = 0, count = segment_count(); i < count; ++i) {
+    if (i + 1 < count) {
+      prefetch(container_[first_element_bucket_ + i + 1], kPrefetchBytes);
+    }
+    function(segment(i));
   }
-  ind -= kBucketSize - first_element_position_;
-  return container_[first_element_bucket_ + 1 + ind / kBucketSize]
-                   [ind % kBucketSize];
 }
 
-template <typename T, typename Allocator>
-T& Deque<T, Allocator>::at(size_t ind) {
+template <typename T, typename Allocator, typename BucketPolicy>
+T& Deque<T, Allocator, BucketPolicy>::operator[](size_t ind) {
+  ind += first_element_position_;
+  return container_[first_element_bucket_ + (ind >> kBucketShift)]
+                   [ind & kBucketMask];
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+const T& Deque<T, Allocator, BucketPolicy>::operator[](size_t ind) const {
+  ind += first_element_position_;
+  return container_[first_element_bucket_ + (ind >> kBucketShift)]
+                   [ind & kBucketMask];
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+T& Deque<T, Allocator, BucketPolicy>::at(size_t ind) {
   if (ind >= size_) {
     throw std::out_of_range("Index out of range");
   }
-  if (ind <= kBucketSize - first_element_position_ - 1) {
-    return container_[first_element_bucket_][first_element_position_ + ind];
-  }
-  ind -= kBucketSize - first_element_position_;
-  return container_[first_element_bucket_ + 1 + ind / kBucketSize]
-                   [ind % kBucketSize];
+  ind += first_element_position_;
+  return container_[first_element_bucket_ + (ind >> kBucketShift)]
+                   [ind & kBucketMask];
 }
 
-template <typename T, typename Allocator>
-const T& Deque<T, Allocator>::at(size_t ind) const {
+template <typename T, typename Allocator, typename BucketPolicy>
+const T& Deque<T, Allocator, BucketPolicy>::at(size_t ind) const {
   if (ind >= size_) {
     throw std::out_of_range("Index out of range");
   }
-  if (ind <= kBucketSize - first_element_position_ - 1) {
-    return container_[first_element_bucket_][first_element_position_ + ind];
+  ind += first_element_position_;
+  return container_[first_element_bucket_ + (ind >> kBucketShift)]
+                   [ind & kBucketMask];
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <std::ranges::random_access_range Indices, typename OutputIt>
+  requires std::ranges::sized_range<const Indices>
+OutputIt Deque<T, Allocator, BucketPolicy>::gather(const Indices& indices,
+                                                   OutputIt out) const {
+  auto index = std::ranges::begin(indices);
+  size_t count = std::ranges::size(indices);
+  for (size_t i = 0; i < count; ++i) {
+    if (i + 2 * kGatherDistance < count) {
+      size_t position =
+          first_element_position_ + index[i + 2 * kGatherDistance];
+      prefetch(container_ + first_element_bucket_ + (position >> kBucketShift),
+               sizeof(T*));
+    }
+    if (i + kGatherDistance < count) {
+      size_t position = first_element_position_ + index[i + kGatherDistance];
+      prefetch(container_[first_element_bucket_ + (position >> kBucketShift)] +
+                   (position & kBucketMask),
+               sizeof(T));
+    }
+    *out = (*this)[index[i]];
+    ++out;
   }
-  ind -= kBucketSize - first_element_position_;
-  return container_[first_element_bucket_ + 1 + ind / kBucketSize]
-                   [ind % kBucketSize];
+  return out;
 }
 
-template <typename T, typename Allocator>
-void Deque<T, Allocator>::reallocation() {
-  size_t new_container_capacity = container_capacity_ * 3 + 1;
-  T** new_container = container_allocator_traits::allocate(
-      container_alloc_, new_container_capacity);
-  size_t buckets_filled = 0;
-  try {
-    for (size_t i = 0; i < container_capacity_; ++i) {
-      container_allocator_traits::construct(
-          container_alloc_, new_container + i,
-          allocator_traits::allocate(alloc_, kBucketSize));
-      ++buckets_filled;
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::prefetch(const void* address,
+                                                 size_t bytes) {
+  if (address == nullptr) {
+    return;
+  }
+#if defined(__GNUC__) || defined(__clang__)
+  const char* line = static_cast<const char*>(address);
+  for (size_t offset = 0; offset < bytes; offset += kCacheLineBytes) {
+    __builtin_prefetch(line + offset);
+  }
+#endif
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::reallocation(bool at_front,
+                                                     size_t extra_buckets) {
+  if constexpr (kIncrementalGrowth) {
+    if (migration_.container != nullptr) {
+      finish_migration();
+      if (at_front ? first_element_bucket_ >= extra_buckets
+                   : last_element_bucket_ + extra_buckets <
+                         container_capacity_) {
+        return;
+      }
     }
+  }
+  std::chrono::steady_clock::time_point started = growth_started();
+  size_t previous_front_offset = front_offset();
+  size_t used_buckets = last_element_bucket_ - first_element_bucket_ + 1;
+  size_t needed_buckets = used_buckets + extra_buckets;
+  size_t front_gap = at_front ? extra_buckets : 0;
+  if (container_capacity_ != 0 && 2 * needed_buckets < container_capacity_) {
+    size_t new_first_bucket =
+        (container_capacity_ - needed_buckets) / 2 + front_gap;
+    if (new_first_bucket < first_element_bucket_) {
+      std::rotate(container_,
+                  container_ + (first_element_bucket_ - new_first_bucket),
+                  container_ + container_capacity_);
+    } else {
+      std::rotate(container_,
+                  container_ + container_capacity_ -
+                      (new_first_bucket - first_element_bucket_),
+                  container_ + container_capacity_);
+    }
+    last_element_bucket_ = new_first_bucket + used_buckets - 1;
+    first_element_bucket_ = new_first_bucket;
+    rebase_handles(previous_front_offset);
+    growth_finished(started, container_capacity_ * sizeof(T*));
+    return;
+  }
+  size_t new_container_capacity =
+      container_capacity_ + std::max(container_capacity_, needed_buckets) + 1;
+  T** new_container = allocate_container(new_container_capacity);
+  size_t new_first_bucket =
+      (new_container_capacity - needed_buckets) / 2 + front_gap;
+  size_t moved_buckets = 0;
+  if (container_capacity_ != 0) {
+    size_t front_slot = new_first_bucket;
+    size_t back_slot = new_first_bucket + used_buckets;
     for (size_t i = 0; i < container_capacity_; ++i) {
-      container_allocator_traits::construct(
-          container_alloc_, new_container + container_capacity_ + i,
-          container_[i]);
-      ++buckets_filled;
+      if (i >= first_element_bucket_ && i <= last_element_bucket_) {
+        new_container[new_first_bucket + i - first_element_bucket_] =
+            container_[i];
+        ++moved_buckets;
+      } else if (container_[i] != nullptr) {
+        ++moved_buckets;
+        if (at_front ? front_slot != 0
+                     : back_slot == new_container_capacity) {
+          new_container[--front_slot] = container_[i];
+        } else {
+          new_container[back_slot++] = container_[i];
+        }
+      }
+    }
+    deallocate_container(container_, container_capacity_);
+  }
+  last_element_bucket_ = new_first_bucket + used_buckets - 1;
+  first_element_bucket_ = new_first_bucket;
+  rebase_handles(previous_front_offset);
+  container_capacity_ = new_container_capacity;
+  container_ = new_container;
+  growth_finished(started, moved_buckets * sizeof(T*));
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+std::chrono::steady_clock::time_point
+Deque<T, Allocator, BucketPolicy>::growth_started() const {
+  if constexpr (kCollectStats) {
+    return std::chrono::steady_clock::now();
+  } else {
+    return {};
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::growth_finished(
+    std::chrono::steady_clock::time_point started, size_t bytes_moved) {
+  if constexpr (kCollectStats) {
+    DequeStats& stats = stats_.stats;
+    stats.growth_time += std::chrono::steady_clock::now() - started;
+    ++stats.reallocations;
+    stats.bytes_moved += bytes_moved;
+    stats.peak_container_capacity =
+        std::max(stats.peak_container_capacity, container_capacity_);
+    if (stats_.growth_callback) {
+      stats_.growth_callback(this->stats());
+    }
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::record_size() {
+  if constexpr (kCollectStats) {
+    stats_.stats.peak_size = std::max(stats_.stats.peak_size, size_);
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+bool Deque<T, Allocator, BucketPolicy>::uses_inline_storage() const {
+  if constexpr (kInlineStorage) {
+    return container_ == inline_.container;
+  } else {
+    return false;
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+size_t Deque<T, Allocator, BucketPolicy>::inline_room(bool at_front) const {
+  return at_front ? first_element_position_ + (empty() ? 1 : 0)
+                  : kInlineElements - last_element_position_ -
+                        (empty() ? 0 : 1);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+bool Deque<T, Allocator, BucketPolicy>::moves_inline_elements(
+    size_t count) const {
+  return uses_inline_storage() &&
+         count > std::min(inline_room(false), inline_room(true));
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::prepare_inline_storage(
+    [[maybe_unused]] bool at_front, [[maybe_unused]] size_t count) {
+  if constexpr (kInlineStorage) {
+    if (container_capacity_ == 0 && count <= kInlineElements) {
+      inline_.container[0] = reinterpret_cast<T*>(inline_.elements);
+      inline_.container[1] = nullptr;
+      container_ = inline_.container;
+      container_capacity_ = 1;
+      first_element_bucket_ = 0;
+      last_element_bucket_ = 0;
+      first_element_position_ = at_front ? kInlineElements - 1 : 0;
+      last_element_position_ = first_element_position_;
+      return;
     }
-    for (size_t i = 2 * container_capacity_; i < new_container_capacity; ++i) {
-      container_allocator_traits::construct(
-          container_alloc_, new_container + i,
-          allocator_traits::allocate(alloc_, kBucketSize));
-      ++buckets_filled;
+    if (!uses_inline_storage() || count <= inline_room(at_front)) {
+      return;
     }
-  } catch (...) {
-    for (size_t i = 0; i < buckets_filled; ++i) {
-      container_allocator_traits::destroy(container_alloc_, new_container + i);
+    if (size_ + count > kInlineElements) {
+      spill_inline_storage();
+      return;
     }
-    container_allocator_traits::deallocate(container_alloc_, new_container,
-                                           new_container_capacity);
+    size_t previous_front_offset = front_offset();
+    size_t start = at_front ? kInlineElements - std::max<size_t>(size_, 1) : 0;
+    relocate_elements(container_[0] + first_element_position_, size_,
+                      container_[0] + start);
+    first_element_position_ = start;
+    last_element_position_ = start + std::max<size_t>(size_, 1) - 1;
+    rebase_handles(previous_front_offset);
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::spill_inline_storage() {
+  if (empty()) {
+    container_ = nullptr;
+    container_capacity_ = 0;
+    first_element_position_ = kInitialPosition;
+    last_element_position_ = kInitialPosition;
+    return;
+  }
+  std::chrono::steady_clock::time_point started = growth_started();
+  size_t previous_front_offset = front_offset();
+  T** container = allocate_container(1);
+  try {
+    container[0] = new_bucket();
+  } catch (...) {
+    deallocate_container(container, 1);
     throw;
   }
-  container_allocator_traits::deallocate(container_alloc_, container_,
-                                         container_capacity_);
-  first_element_bucket_ = container_capacity_ + first_element_bucket_;
-  last_element_bucket_ = container_capacity_ + last_element_bucket_;
-  container_capacity_ = new_container_capacity;
+  size_t start = (kBucketSize - size_) / 2;
+  relocate_elements(container_[0] + first_element_position_, size_,
+                    container[0] + start);
+  container_ = container;
+  first_element_position_ = start;
+  last_element_position_ = start + size_ - 1;
+  rebase_handles(previous_front_offset);
+  growth_finished(started, size_ * sizeof(T));
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::relocate_elements(T* source,
+                                                          size_t count,
+                                                          T* destination) {
+  if constexpr (kTriviallyRelocatable) {
+    std::memmove(static_cast<void*>(destination),
+                 static_cast<const void*>(source), count * sizeof(T));
+  } else if (destination < source) {
+    for (size_t i = 0; i < count; ++i) {
+      allocator_traits::construct(alloc_, destination + i,
+                                  std::move(source[i]));
+      allocator_traits::destroy(alloc_, source + i);
+    }
+  } else {
+    for (size_t i = count; i != 0; --i) {
+      allocator_traits::construct(alloc_, destination + i - 1,
+                                  std::move(source[i - 1]));
+      allocator_traits::destroy(alloc_, source + i - 1);
+    }
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+T* Deque<T, Allocator, BucketPolicy>::new_bucket() {
+  T* bucket = allocator_traits::allocate(alloc_, kBucketSize);
+  if constexpr (kCollectStats) {
+    ++stats_.stats.bucket_allocations;
+  }
+  return bucket;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::delete_bucket(T* bucket) {
+  if constexpr (kInlineStorage) {
+    if (bucket == reinterpret_cast<T*>(inline_.elements)) {
+      return;
+    }
+  }
+  allocator_traits::deallocate(alloc_, bucket, kBucketSize);
+  if constexpr (kCollectStats) {
+    ++stats_.stats.bucket_deallocations;
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+T** Deque<T, Allocator, BucketPolicy>::allocate_container_storage(
+    size_t capacity) {
+  return container_allocator_traits::allocate(container_alloc_, capacity + 1);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+T** Deque<T, Allocator, BucketPolicy>::allocate_container(size_t capacity) {
+  T** container = allocate_container_storage(capacity);
+  for (size_t i = 0; i <= capacity; ++i) {
+    container_allocator_traits::construct(container_alloc_, container + i,
+                                          nullptr);
+  }
+  return container;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::deallocate_container(T** container,
+                                                             size_t capacity) {
+  if constexpr (kInlineStorage) {
+    if (container == inline_.container) {
+      return;
+    }
+  }
+  container_allocator_traits::deallocate(container_alloc_, container,
+                                         capacity + 1);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+size_t Deque<T, Allocator, BucketPolicy>::front_limit() const {
+  if constexpr (kIncrementalGrowth) {
+    if (migration_.container != nullptr) {
+      return migration_.window_first;
+    }
+  }
+  return 0;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+size_t Deque<T, Allocator, BucketPolicy>::back_limit() const {
+  if constexpr (kIncrementalGrowth) {
+    if (migration_.container != nullptr) {
+      return migration_.window_last;
+    }
+  }
+  return container_capacity_ - 1;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::migration_step() {
+  if constexpr (kIncrementalGrowth) {
+    if (uses_inline_storage()) {
+      return;
+    }
+    if (migration_.container != nullptr) {
+      advance_migration(BucketPolicy::kMigrationSlots);
+      return;
+    }
+    size_t threshold = (4 * container_capacity_ + 4) /
+                       (BucketPolicy::kMigrationSlots * kBucketSize);
+    if (first_element_bucket_ < threshold ||
+        last_element_bucket_ + threshold >= container_capacity_) {
+      start_migration();
+    }
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::start_migration() {
+  size_t used_buckets = last_element_bucket_ - first_element_bucket_ + 1;
+  size_t capacity = 2 * (used_buckets + 1) < container_capacity_
+                        ? container_capacity_
+                        : container_capacity_ +
+                              std::max(container_capacity_, used_buckets + 1) +
+                              1;
+  std::ptrdiff_t offset =
+      static_cast<std::ptrdiff_t>((capacity - used_buckets) / 2) -
+      static_cast<std::ptrdiff_t>(first_element_bucket_);
+  migration_.container = allocate_container_storage(capacity);
+  migration_.capacity = capacity;
+  migration_.offset = offset;
+  migration_.window_first = offset < 0 ? -offset : 0;
+  migration_.window_last = std::min<std::ptrdiff_t>(
+      container_capacity_ - 1, static_cast<std::ptrdiff_t>(capacity) - 1 -
+                                   offset);
+  migration_.copied = 0;
+  migration_.released = 0;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::advance_migration(size_t slots) {
+  size_t outside = migration_.window_first + container_capacity_ - 1 -
+                   migration_.window_last;
+  for (size_t end = migration_.released +
+                    std::min(slots, outside - migration_.released);
+       migration_.released < end; ++migration_.released) {
+    size_t bucket = migration_.released < migration_.window_first
+                        ? migration_.released
+                        : migration_.window_last + 1 + migration_.released -
+                              migration_.window_first;
+    if (container_[bucket] != nullptr) {
+      release_bucket(bucket);
+    }
+  }
+  for (size_t end = migration_.copied +
+                    std::min(slots, migration_.capacity + 1 -
+                                        migration_.copied);
+       migration_.copied < end; ++migration_.copied) {
+    std::ptrdiff_t bucket =
+        static_cast<std::ptrdiff_t>(migration_.copied) - migration_.offset;
+    container_allocator_traits::construct(
+        container_alloc_, migration_.container + migration_.copied,
+        bucket >= static_cast<std::ptrdiff_t>(migration_.window_first) &&
+                bucket <= static_cast<std::ptrdiff_t>(migration_.window_last)
+            ? container_[bucket]
+            : nullptr);
+  }
+  if (migration_.released != outside ||
+      migration_.copied != migration_.capacity + 1) {
+    return;
+  }
+  std::chrono::steady_clock::time_point started = growth_started();
+  deallocate_container(container_, container_capacity_);
+  container_ = migration_.container;
+  container_capacity_ = migration_.capacity;
+  size_t previous_front_offset = front_offset();
+  first_element_bucket_ += migration_.offset;
+  last_element_bucket_ += migration_.offset;
+  rebase_handles(previous_front_offset);
+  migration_.container = nullptr;
+  growth_finished(started, migration_.copied * sizeof(T*));
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::finish_migration() {
+  if constexpr (kIncrementalGrowth) {
+    if (migration_.container != nullptr) {
+      advance_migration(std::numeric_limits<size_t>::max());
+    }
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::cancel_migration() {
+  if constexpr (kIncrementalGrowth) {
+    if (migration_.container != nullptr) {
+      deallocate_container(migration_.container, migration_.capacity);
+      migration_.container = nullptr;
+    }
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+DequeStats Deque<T, Allocator, BucketPolicy>::stats() const
+  requires CollectsStats<BucketPolicy>
+{
+  DequeStats stats = stats_.stats;
+  size_t allocated_buckets = spare_bucket_count_;
+  for (size_t i = 0; i < container_capacity_; ++i) {
+    allocated_buckets += container_[i] != nullptr ? 1 : 0;
+  }
+  stats.wasted_slots = allocated_buckets * kBucketSize - size_;
+  return stats;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::set_growth_callback(
+    std::function<void(const DequeStats&)> callback)
+  requires CollectsStats<BucketPolicy>
+{
+  stats_.growth_callback = std::move(callback);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+DequeHandle Deque<T, Allocator, BucketPolicy>::handle(size_t index) const
+  requires HasStableHandles<BucketPolicy>
+{
+  return {handles_.sequence_base + front_offset() + index,
+          handles_.generation};
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+T* Deque<T, Allocator, BucketPolicy>::resolve(DequeHandle handle)
+  requires HasStableHandles<BucketPolicy>
+{
+  size_t index = handle_index(handle);
+  return index < size_ ? &(*this)[index] : nullptr;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+const T* Deque<T, Allocator, BucketPolicy>::resolve(DequeHandle handle) const
+  requires HasStableHandles<BucketPolicy>
+{
+  size_t index = handle_index(handle);
+  return index < size_ ? &(*this)[index] : nullptr;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+size_t Deque<T, Allocator, BucketPolicy>::front_offset() const {
+  return (first_element_bucket_ << kBucketShift) + first_element_position_;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+size_t Deque<T, Allocator, BucketPolicy>::handle_index(
+    DequeHandle handle) const {
+  if constexpr (kStableHandles) {
+    size_t index = handle.sequence - handles_.sequence_base - front_offset();
+    if (index < size_ && handle.generation >= handles_.valid_generation &&
+        !reused_since(handles_.front_reused, handle, index) &&
+        !reused_since(handles_.back_reused, handle, index)) {
+      return index;
+    }
+  }
+  return size_;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::track_pop(
+    [[maybe_unused]] bool at_front) {
+  if constexpr (kStableHandles) {
+    (at_front ? handles_.front_reused : handles_.back_reused).open = false;
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+bool Deque<T, Allocator, BucketPolicy>::reused_since(const HandleRange& range,
+                                                     DequeHandle handle,
+                                                     size_t index) const {
+  size_t front = handles_.sequence_base + front_offset();
+  return handle.generation < range.generation &&
+         static_cast<std::ptrdiff_t>(range.first - front) <=
+             static_cast<std::ptrdiff_t>(index) &&
+         static_cast<std::ptrdiff_t>(index) <
+             static_cast<std::ptrdiff_t>(range.last - front);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::rebase_handles(
+    [[maybe_unused]] size_t previous_front_offset) {
+  if constexpr (kStableHandles) {
+    handles_.sequence_base += previous_front_offset - front_offset();
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::invalidate_handles() {
+  if constexpr (kStableHandles) {
+    handles_.valid_generation = ++handles_.generation;
+    handles_.front_low = handles_.sequence_base + front_offset();
+    handles_.back_high = handles_.front_low + size_;
+    handles_.front_reused = {};
+    handles_.back_reused = {};
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::track_front_push(
+    [[maybe_unused]] size_t count) {
+  if constexpr (kStableHandles) {
+    size_t front = handles_.sequence_base + front_offset();
+    if (size_ == count) {
+      invalidate_handles();
+      return;
+    }
+    auto low = static_cast<std::ptrdiff_t>(handles_.front_low - front);
+    auto pushed = static_cast<std::ptrdiff_t>(count);
+    HandleRange& range = handles_.front_reused;
+    if (low < pushed) {
+      size_t first = front + std::max<std::ptrdiff_t>(low, 0);
+      if (range.open && range.first == front + count) {
+        range.first = first;
+      } else {
+        auto old_first = static_cast<std::ptrdiff_t>(range.first - front);
+        auto old_last = std::min(static_cast<std::ptrdiff_t>(range.last - front),
+                                 static_cast<std::ptrdiff_t>(size_));
+        size_t last = range.first != range.last &&
+                              std::max(old_first, pushed) < old_last
+                          ? front + old_last
+                          : front + count;
+        range = {first, last, ++handles_.generation};
+      }
+    }
+    range.open = low < pushed && low <= 0;
+    if (low > 0) {
+      handles_.front_low = front;
+    }
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::track_back_push(
+    [[maybe_unused]] size_t count) {
+  if constexpr (kStableHandles) {
+    size_t front = handles_.sequence_base + front_offset();
+    if (size_ == count) {
+      invalidate_handles();
+      return;
+    }
+    auto high = static_cast<std::ptrdiff_t>(handles_.back_high - front);
+    auto start = static_cast<std::ptrdiff_t>(size_ - count);
+    HandleRange& range = handles_.back_reused;
+    if (high > start) {
+      size_t last =
+          front + std::min(high, static_cast<std::ptrdiff_t>(size_));
+      if (range.open && range.last == front + start) {
+        range.last = last;
+      } else {
+        auto old_first =
+            std::max(static_cast<std::ptrdiff_t>(range.first - front),
+                     std::ptrdiff_t{0});
+        auto old_last = static_cast<std::ptrdiff_t>(range.last - front);
+        size_t first = range.first != range.last &&
+                               old_first < std::min(old_last, start)
+                           ? front + old_first
+                           : front + start;
+        range = {first, last, ++handles_.generation};
+      }
+    }
+    range.open = high >= static_cast<std::ptrdiff_t>(size_);
+    if (high < static_cast<std::ptrdiff_t>(size_)) {
+      handles_.back_high = front + size_;
+    }
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::reserve_back(size_t count) {
+  if (count == 0) {
+    return;
+  }
+  prepare_inline_storage(false, count);
+  size_t extra_buckets =
+      (last_element_position_ + (empty() ? 0 : 1) + count - 1) >> kBucketShift;
+  if (container_capacity_ == 0 ||
+      last_element_bucket_ + extra_buckets > back_limit()) {
+    reallocation(false, extra_buckets);
+  }
+  for (size_t i = 0; i <= extra_buckets; ++i) {
+    allocate_bucket(last_element_bucket_ + i);
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::reserve_front(size_t count) {
+  if (count == 0) {
+    return;
+  }
+  prepare_inline_storage(true, count);
+  size_t available = first_element_position_ + (empty() ? 1 : 0);
+  size_t extra_buckets =
+      count > available ? (count - available + kBucketMask) >> kBucketShift
+                        : 0;
+  if (container_capacity_ == 0 ||
+      extra_buckets + front_limit() > first_element_bucket_) {
+    reallocation(true, extra_buckets);
+  }
+  for (size_t i = 0; i <= extra_buckets; ++i) {
+    allocate_bucket(first_element_bucket_ - i);
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::shrink_to_fit() {
+  if (container_ == nullptr || uses_inline_storage()) {
+    return;
+  }
+  cancel_migration();
+  size_t previous_front_offset = front_offset();
+  size_t used_buckets =
+      empty() ? 0 : last_element_bucket_ - first_element_bucket_ + 1;
+  T** new_container = nullptr;
+  if (used_buckets != 0) {
+    new_container = allocate_container(used_buckets);
+  }
+  for (size_t i = 0; i < container_capacity_; ++i) {
+    if (used_buckets != 0 && i >= first_element_bucket_ &&
+        i <= last_element_bucket_) {
+      new_container[i - first_element_bucket_] = container_[i];
+    } else if (container_[i] != nullptr) {
+      delete_bucket(container_[i]);
+    }
+  }
+  deallocate_container(container_, container_capacity_);
+  release_spare_buckets();
   container_ = new_container;
+  container_capacity_ = used_buckets;
+  last_element_bucket_ -= first_element_bucket_;
+  first_element_bucket_ = 0;
+  if (used_buckets == 0) {
+    last_element_bucket_ = 0;
+    first_element_position_ = kInitialPosition;
+    last_element_position_ = kInitialPosition;
+  }
+  rebase_handles(previous_front_offset);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::allocate_bucket(size_t bucket) {
+  if (container_[bucket] == nullptr) {
+    container_[bucket] = spare_bucket_count_ != 0
+                             ? spare_buckets_[--spare_bucket_count_]
+                             : new_bucket();
+    if constexpr (kIncrementalGrowth) {
+      if (migration_.container != nullptr &&
+          bucket >= migration_.window_first &&
+          bucket <= migration_.window_last &&
+          static_cast<std::ptrdiff_t>(bucket) + migration_.offset <
+              static_cast<std::ptrdiff_t>(migration_.copied)) {
+        migration_.container[bucket + migration_.offset] = container_[bucket];
+      }
+    }
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::release_bucket(size_t bucket) {
+  if (spare_bucket_count_ != spare_buckets_.size()) {
+    spare_buckets_[spare_bucket_count_++] = container_[bucket];
+  } else {
+    delete_bucket(container_[bucket]);
+  }
+  container_[bucket] = nullptr;
+  if constexpr (kIncrementalGrowth) {
+    if (migration_.container != nullptr && bucket >= migration_.window_first &&
+        bucket <= migration_.window_last &&
+        static_cast<std::ptrdiff_t>(bucket) + migration_.offset <
+            static_cast<std::ptrdiff_t>(migration_.copied)) {
+      migration_.container[bucket + migration_.offset] = nullptr;
+    }
+  }
 }
 
-template <typename T, typename Allocator>
-void Deque<T, Allocator>::push_back(T&& value) {
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::push_back(T&& value) {
   emplace_back(std::move(value));
 }
 
-template <typename T, typename Allocator>
-void Deque<T, Allocator>::push_back(const T& value) {
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::push_back(const T& value) {
   emplace_back(value);
 }
 
-template <typename T, typename Allocator>
-void Deque<T, Allocator>::pop_back() {
-  allocator_traits::destroy(
-      alloc_, container_[last_element_bucket_] + last_element_position_);
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::pop_back() {
+  if constexpr (!kTriviallyDestructible) {
+    allocator_traits::destroy(
+        alloc_, container_[last_element_bucket_] + last_element_position_);
+  }
   --size_;
+  track_pop(false);
   if (!empty()) {
     if (last_element_position_ == 0) {
+      release_bucket(last_element_bucket_);
       --last_element_bucket_;
-      last_element_position_ = kBucketSize - 1;
+      last_element_position_ = kBucketMask;
     } else {
       --last_element_position_;
     }
+  } else {
+    reset_empty_position();
   }
+  migration_step();
 }
 
-template <typename T, typename Allocator>
-void Deque<T, Allocator>::push_front(T&& value) {
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::push_front(T&& value) {
   emplace_front(std::move(value));
 }
 
-template <typename T, typename Allocator>
-void Deque<T, Allocator>::push_front(const T& value) {
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::push_front(const T& value) {
   emplace_front(value);
 }
 
-template <typename T, typename Allocator>
-void Deque<T, Allocator>::pop_front() {
-  allocator_traits::destroy(
-      alloc_, container_[first_element_bucket_] + first_element_position_);
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::pop_front() {
+  if constexpr (!kTriviallyDestructible) {
+    allocator_traits::destroy(
+        alloc_, container_[first_element_bucket_] + first_element_position_);
+  }
   --size_;
+  track_pop(true);
   if (!empty()) {
-    if (first_element_position_ == kBucketSize - 1) {
+    if (first_element_position_ == kBucketMask) {
+      release_bucket(first_element_bucket_);
       ++first_element_bucket_;
       first_element_position_ = 0;
     } else {
       ++first_element_position_;
     }
+  } else {
+    reset_empty_position();
+  }
+  migration_step();
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::pop_back(size_t count) {
+  destroy_elements(size_ - count, count);
+  discard_back(count);
+  migration_step();
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::pop_front(size_t count) {
+  destroy_elements(0, count);
+  discard_front(count);
+  migration_step();
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename OutputIt>
+OutputIt Deque<T, Allocator, BucketPolicy>::drain_front(size_t count,
+                                                        OutputIt out) {
+  count = std::min(count, size_);
+  for (size_t index = 0; index < count;) {
+    size_t chunk = std::min(count - index, contiguous_elements(index));
+    T* source = &(*this)[index];
+    out = std::move(source, source + chunk, out);
+    index += chunk;
   }
+  pop_front(count);
+  return out;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <typename... Arguments>
-void Deque<T, Allocator>::emplace_back(Arguments&&... args) {
+void Deque<T, Allocator, BucketPolicy>::emplace_back(Arguments&&... args) {
+  if constexpr (kInlineStorage) {
+    if (uses_inline_storage() && inline_room(false) == 0) {
+      T value(std::forward<Arguments>(args)...);
+      prepare_inline_storage(false, 1);
+      emplace_back(std::move(value));
+      return;
+    }
+    prepare_inline_storage(false, 1);
+  }
   if (container_capacity_ == 0 ||
-      last_element_bucket_ == container_capacity_ - 1 &&
-          last_element_position_ == kBucketSize - 1) {
-    reallocation();
+      (!empty() && last_element_bucket_ == back_limit() &&
+       last_element_position_ == kBucketMask)) {
+    reallocation(false);
   }
-  try {
-    if (!empty()) {
-      if (last_element_position_ == kBucketSize - 1) {
-        ++last_element_bucket_;
-        last_element_position_ = 0;
-      } else {
-        ++last_element_position_;
-      }
-    }
-    allocator_traits::construct(
-        alloc_, container_[last_element_bucket_] + last_element_position_,
-        std::forward<Arguments>(args)...);
-  } catch (...) {
-    allocator_traits::destroy(
-        alloc_, container_[last_element_bucket_] + last_element_position_);
-    if (last_element_position_ == 0) {
-      --last_element_bucket_;
-      last_element_position_ = kBucketSize - 1;
+  size_t bucket = last_element_bucket_;
+  size_t position = last_element_position_;
+  if (!empty()) {
+    if (position == kBucketMask) {
+      ++bucket;
+      position = 0;
     } else {
-      --last_element_position_;
+      ++position;
     }
-    throw;
   }
+  allocate_bucket(bucket);
+  allocator_traits::construct(alloc_, container_[bucket] + position,
+                              std::forward<Arguments>(args)...);
+  last_element_bucket_ = bucket;
+  last_element_position_ = position;
   ++size_;
+  record_size();
+  track_back_push(1);
+  migration_step();
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <typename... Arguments>
-void Deque<T, Allocator>::emplace_front(Arguments&&... args) {
+void Deque<T, Allocator, BucketPolicy>::emplace_front(Arguments&&... args) {
+  if constexpr (kInlineStorage) {
+    if (uses_inline_storage() && inline_room(true) == 0) {
+      T value(std::forward<Arguments>(args)...);
+      prepare_inline_storage(true, 1);
+      emplace_front(std::move(value));
+      return;
+    }
+    prepare_inline_storage(true, 1);
+  }
   if (container_capacity_ == 0 ||
-      first_element_bucket_ == 0 && first_element_position_ == 0) {
-    reallocation();
+      (!empty() && first_element_bucket_ == front_limit() &&
+       first_element_position_ == 0)) {
+    reallocation(true);
   }
-  try {
-    if (!empty()) {
-      if (first_element_position_ == 0) {
-        first_element_position_ = kBucketSize - 1;
-        --first_element_bucket_;
-      } else {
-        --first_element_position_;
-      }
-    }
-    allocator_traits::construct(
-        alloc_, container_[first_element_bucket_] + first_element_position_,
-        std::forward<Arguments>(args)...);
-  } catch (...) {
-    allocator_traits::destroy(
-        alloc_, container_[first_element_bucket_] + first_element_position_);
-    if (first_element_position_ == kBucketSize - 1) {
-      ++first_element_bucket_;
-      first_element_position_ = 0;
+  size_t bucket = first_element_bucket_;
+  size_t position = first_element_position_;
+  if (!empty()) {
+    if (position == 0) {
+      --bucket;
+      position = kBucketMask;
     } else {
-      ++first_element_position_;
+      --position;
     }
   }
+  allocate_bucket(bucket);
+  allocator_traits::construct(alloc_, container_[bucket] + position,
+                              std::forward<Arguments>(args)...);
+  first_element_bucket_ = bucket;
+  first_element_position_ = position;
   ++size_;
+  record_size();
+  track_front_push(1);
+  migration_step();
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-class Deque<T, Allocator>::Iterator {
+class Deque<T, Allocator, BucketPolicy>::Iterator {
  public:
   using iterator_category = std::random_access_iterator_tag;
   using cond_type = std::conditional_t<IsConst, const T, T>;
-  using value_type = cond_type;
+  using value_type = T;
   using pointer = cond_type*;
   using reference = cond_type&;
   using difference_type = std::ptrdiff_t;
 
-  Iterator(T** ptr, size_t bucket_number, size_t position);
+  Iterator() = default;
+  Iterator(T** node, size_t position);
   Iterator(const Iterator& other) = default;
   Iterator& operator=(const Iterator& other) = default;
 
@@ -604,10 +1599,13 @@ class Deque<T, Allocator>::Iterator {
   Iterator& operator--();
   Iterator operator++(int);
   Iterator operator--(int);
-  Iterator& operator+=(int number);
-  Iterator& operator-=(int number);
-  Iterator operator+(int number) const;
-  Iterator operator-(int number) const;
+  Iterator& operator+=(difference_type number);
+  Iterator& operator-=(difference_type number);
+  Iterator operator+(difference_type number) const;
+  Iterator operator-(difference_type number) const;
+  friend Iterator operator+(difference_type number, const Iterator& iter) {
+    return iter + number;
+  }
 
   bool operator<(const Iterator& other) const;
   bool operator==(const Iterator& other) const;
@@ -616,271 +1614,726 @@ class Deque<T, Allocator>::Iterator {
   bool operator<=(const Iterator& other) const;
   bool operator>=(const Iterator& other) const;
 
-  difference_type operator-(const Iterator& other);
+  difference_type operator-(const Iterator& other) const;
   reference operator*() const;
   pointer operator->() const;
+  reference operator[](difference_type number) const;
 
  private:
-  T** ptr_ = nullptr;
-  int bucket_number_ = 0;
-  int position_ = 0;
+  void set_node(T** node);
+
+  T** node_ = nullptr;
+  T* first_ = nullptr;
+  T* cur_ = nullptr;
 };
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-typename Deque<T, Allocator>::template Iterator<IsConst>::difference_type
-Deque<T, Allocator>::Iterator<IsConst>::operator-(
-    const Deque<T, Allocator>::Iterator<IsConst>& other) {
-  return kBucketSize * bucket_number_ + position_ -
-         (kBucketSize * other.bucket_number_ + other.position_);
+typename Deque<T, Allocator, BucketPolicy>::template Iterator<
+    IsConst>::difference_type
+Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator-(
+    const Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>& other) const {
+  return (node_ - other.node_) * static_cast<difference_type>(kBucketSize) +
+         (cur_ - first_) - (other.cur_ - other.first_);
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-typename Deque<T, Allocator>::template Iterator<IsConst>::pointer
-Deque<T, Allocator>::Iterator<IsConst>::operator->() const {
-  return ptr_[bucket_number_] + position_;
+typename Deque<T, Allocator, BucketPolicy>::template Iterator<
+    IsConst>::pointer
+Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator->() const {
+  return cur_;
 }
 
-template <typename T, typename Allocator>
-void Deque<T, Allocator>::erase(Deque::iterator iter) {
-  for (auto position = iter; position != end() - 1; ++position) {
-    std::swap(*iter, *(iter + 1));
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+typename Deque<T, Allocator, BucketPolicy>::template Iterator<
+    IsConst>::reference
+Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator[](
+    difference_type number) const {
+  return *(*this + number);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::release_spare_buckets() {
+  for (size_t i = 0; i < spare_bucket_count_; ++i) {
+    delete_bucket(spare_buckets_[i]);
   }
-  pop_back();
+  spare_bucket_count_ = 0;
 }
 
-template <typename T, typename Allocator>
-void Deque<T, Allocator>::insert(Deque::iterator iter, const T& value) {
-  if (empty()) {
-    push_back(value);
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename InputIt>
+InputIt Deque<T, Allocator, BucketPolicy>::construct_range(T* destination,
+                                                           size_t count,
+                                                           InputIt first) {
+  if constexpr (kTriviallyCopyable && std::contiguous_iterator<InputIt> &&
+                std::is_same_v<std::iter_value_t<InputIt>, T>) {
+    std::memcpy(destination, std::to_address(first), count * sizeof(T));
+    return first + count;
+  } else if constexpr (kDefaultAllocator && std::forward_iterator<InputIt>) {
+    InputIt last = std::next(first, count);
+    std::uninitialized_copy(first, last, destination);
+    return last;
+  } else {
+    size_t constructed = 0;
+    try {
+      for (; constructed < count; ++constructed, ++first) {
+        allocator_traits::construct(alloc_, destination + constructed, *first);
+      }
+    } catch (...) {
+      for (size_t i = 0; i < constructed; ++i) {
+        allocator_traits::destroy(alloc_, destination + i);
+      }
+      throw;
+    }
+    return first;
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename... Arguments>
+void Deque<T, Allocator, BucketPolicy>::construct_fill(
+    T* destination, size_t count, const Arguments&... args) {
+  if constexpr (kDefaultAllocator) {
+    if constexpr (sizeof...(Arguments) == 0) {
+      std::uninitialized_value_construct_n(destination, count);
+    } else {
+      std::uninitialized_fill_n(destination, count, args...);
+    }
   } else {
-    auto iter_2 = end() - 1;
-    T last_element = *iter_2;
-    *iter_2 = value;
-    while (iter_2 > iter) {
-      std::swap(*(iter_2 - 1), *iter_2);
-      --iter_2;
+    size_t constructed = 0;
+    try {
+      for (; constructed < count; ++constructed) {
+        allocator_traits::construct(alloc_, destination + constructed, args...);
+      }
+    } catch (...) {
+      for (size_t i = 0; i < constructed; ++i) {
+        allocator_traits::destroy(alloc_, destination + i);
+      }
+      throw;
     }
-    push_back(last_element);
-    std::swap(*(end() - 2), *(end() - 1));
   }
 }
 
-template <typename T, typename Allocator>
-void Deque<T, Allocator>::emplace(Deque::iterator iter, T&& value) {
-  if (empty()) {
-    push_back(std::move(value));
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename Constructor>
+void Deque<T, Allocator, BucketPolicy>::append_elements(size_t count,
+                                                        Constructor construct) {
+  if (count == 0) {
+    return;
+  }
+  reserve_back(count);
+  size_t end_offset = (last_element_bucket_ << kBucketShift) +
+                      last_element_position_ + (empty() ? 0 : 1);
+  size_t appended = 0;
+  try {
+    while (appended < count) {
+      size_t bucket = end_offset >> kBucketShift;
+      size_t position = end_offset & kBucketMask;
+      size_t chunk = std::min(count - appended, kBucketSize - position);
+      construct(container_[bucket] + position, chunk);
+      last_element_bucket_ = bucket;
+      last_element_position_ = position + chunk - 1;
+      size_ += chunk;
+      appended += chunk;
+      end_offset += chunk;
+    }
+  } catch (...) {
+    destroy_elements(size_ - appended, appended);
+    discard_back(appended);
+    throw;
+  }
+  record_size();
+  track_back_push(count);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename Constructor>
+void Deque<T, Allocator, BucketPolicy>::prepend_elements(
+    size_t count, Constructor construct) {
+  if (count == 0) {
+    return;
+  }
+  reserve_front(count);
+  size_t start = (first_element_bucket_ << kBucketShift) +
+                 first_element_position_ + (empty() ? 1 : 0) - count;
+  size_t prepended = 0;
+  try {
+    while (prepended < count) {
+      size_t bucket = (start + prepended) >> kBucketShift;
+      size_t position = (start + prepended) & kBucketMask;
+      size_t chunk = std::min(count - prepended, kBucketSize - position);
+      construct(container_[bucket] + position, chunk);
+      prepended += chunk;
+    }
+  } catch (...) {
+    for (size_t i = start; i < start + prepended; ++i) {
+      allocator_traits::destroy(
+          alloc_, container_[i >> kBucketShift] + (i & kBucketMask));
+    }
+    throw;
+  }
+  first_element_bucket_ = start >> kBucketShift;
+  first_element_position_ = start & kBucketMask;
+  size_ += count;
+  record_size();
+  track_front_push(count);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool Relocate>
+void Deque<T, Allocator, BucketPolicy>::move_elements(size_t source,
+                                                      size_t count,
+                                                      size_t destination) {
+  if (source == destination || count == 0) {
+    return;
+  }
+  invalidate_handles();
+  source += first_element_position_;
+  destination += first_element_position_;
+  if (destination < source) {
+    while (count != 0) {
+      size_t chunk = std::min({count, kBucketSize - (source & kBucketMask),
+                               kBucketSize - (destination & kBucketMask)});
+      T* from = container_[first_element_bucket_ + (source >> kBucketShift)] +
+                (source & kBucketMask);
+      T* to = container_[first_element_bucket_ +
+                         (destination >> kBucketShift)] +
+              (destination & kBucketMask);
+      if constexpr (Relocate || std::is_trivially_copyable_v<T>) {
+        std::memmove(static_cast<void*>(to), static_cast<const void*>(from),
+                     chunk * sizeof(T));
+      } else {
+        std::move(from, from + chunk, to);
+      }
+      source += chunk;
+      destination += chunk;
+      count -= chunk;
+    }
+  } else {
+    source += count;
+    destination += count;
+    while (count != 0) {
+      size_t chunk = std::min({count, ((source - 1) & kBucketMask) + 1,
+                               ((destination - 1) & kBucketMask) + 1});
+      T* from =
+          container_[first_element_bucket_ + ((source - 1) >> kBucketShift)] +
+          ((source - 1) & kBucketMask) + 1;
+      T* to = container_[first_element_bucket_ +
+                         ((destination - 1) >> kBucketShift)] +
+              ((destination - 1) & kBucketMask) + 1;
+      if constexpr (Relocate || std::is_trivially_copyable_v<T>) {
+        std::memmove(static_cast<void*>(to - chunk),
+                     static_cast<const void*>(from - chunk), chunk * sizeof(T));
+      } else {
+        std::move_backward(from - chunk, from, to);
+      }
+      source -= chunk;
+      destination -= chunk;
+      count -= chunk;
+    }
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::iterator
+Deque<T, Allocator, BucketPolicy>::erase(Deque::iterator iter) {
+  return erase(iter, iter + 1);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::iterator
+Deque<T, Allocator, BucketPolicy>::erase(Deque::iterator first,
+                                         Deque::iterator last) {
+  size_t index = first - begin();
+  size_t count = last - first;
+  if (count == 0) {
+    return begin() + index;
+  }
+  invalidate_handles();
+  size_t tail = size_ - index - count;
+  if (index < tail) {
+    if constexpr (kTriviallyRelocatable) {
+      destroy_elements(index, count);
+      move_elements<true>(0, index, count);
+    } else {
+      move_elements(0, index, count);
+      destroy_elements(0, count);
+    }
+    discard_front(count);
+  } else {
+    if constexpr (kTriviallyRelocatable) {
+      destroy_elements(index, count);
+      move_elements<true>(index + count, tail, index);
+    } else {
+      move_elements(index + count, tail, index);
+      destroy_elements(index + tail, count);
+    }
+    discard_back(count);
+  }
+  return begin() + index;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::destroy_elements(size_t index,
+                                                         size_t count) {
+  if constexpr (!kTriviallyDestructible) {
+    while (count != 0) {
+      size_t chunk = std::min(count, contiguous_elements(index));
+      T* element = &(*this)[index];
+      for (T* last = element + chunk; element != last; ++element) {
+        allocator_traits::destroy(alloc_, element);
+      }
+      index += chunk;
+      count -= chunk;
+    }
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::discard_front(size_t count) {
+  size_ -= count;
+  track_pop(true);
+  size_t start = empty() ? (last_element_bucket_ << kBucketShift) +
+                               last_element_position_
+                         : (first_element_bucket_ << kBucketShift) +
+                               first_element_position_ + count;
+  for (size_t i = first_element_bucket_; i < (start >> kBucketShift); ++i) {
+    release_bucket(i);
+  }
+  first_element_bucket_ = start >> kBucketShift;
+  first_element_position_ = start & kBucketMask;
+  reset_empty_position();
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void Deque<T, Allocator, BucketPolicy>::discard_back(size_t count) {
+  size_ -= count;
+  track_pop(false);
+  size_t finish = empty() ? (first_element_bucket_ << kBucketShift) +
+                                first_element_position_
+                          : (last_element_bucket_ << kBucketShift) +
+                                last_element_position_ - count;
+  for (size_t i = (finish >> kBucketShift) + 1; i <= last_element_bucket_;
+       ++i) {
+    release_bucket(i);
+  }
+  last_element_bucket_ = finish >> kBucketShift;
+  last_element_position_ = finish & kBucketMask;
+  reset_empty_position();
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::iterator
+Deque<T, Allocator, BucketPolicy>::insert(Deque::iterator iter,
+                                          const T& value) {
+  return emplace(iter, value);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::iterator
+Deque<T, Allocator, BucketPolicy>::insert(Deque::iterator iter, T&& value) {
+  return emplace(iter, std::move(value));
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::iterator
+Deque<T, Allocator, BucketPolicy>::insert(Deque::iterator iter, size_t count,
+                                          const T& value) {
+  if constexpr (kInlineStorage) {
+    if (moves_inline_elements(count)) {
+      T copy(value);
+      return insert_elements(iter, count, [&](T* destination, size_t length) {
+        construct_fill(destination, length, copy);
+      });
+    }
+  }
+  return insert_elements(iter, count, [&](T* destination, size_t length) {
+    construct_fill(destination, length, value);
+  });
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <std::input_iterator InputIt>
+typename Deque<T, Allocator, BucketPolicy>::iterator
+Deque<T, Allocator, BucketPolicy>::insert(Deque::iterator iter, InputIt first,
+                                          InputIt last) {
+  if constexpr (std::forward_iterator<InputIt>) {
+    size_t count = std::distance(first, last);
+    if constexpr (kInlineStorage) {
+      if (moves_inline_elements(count)) {
+        Deque copy(alloc_);
+        copy.append_range(std::ranges::subrange(first, last));
+        auto element = std::make_move_iterator(copy.begin());
+        return insert_elements(iter, count, [&](T* destination, size_t length) {
+          element = construct_range(destination, length, element);
+        });
+      }
+    }
+    return insert_elements(iter, count, [&](T* destination, size_t length) {
+      first = construct_range(destination, length, first);
+    });
+  } else {
+    invalidate_handles();
+    size_t index = iter - begin();
+    size_t old_size = size_;
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+    std::rotate(begin() + index, begin() + old_size, end());
+    return begin() + index;
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::iterator
+Deque<T, Allocator, BucketPolicy>::insert(Deque::iterator iter,
+                                          std::initializer_list<T> init) {
+  return insert(iter, init.begin(), init.end());
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename Constructor>
+typename Deque<T, Allocator, BucketPolicy>::iterator
+Deque<T, Allocator, BucketPolicy>::insert_elements(Deque::iterator iter,
+                                                   size_t count,
+                                                   Constructor construct) {
+  invalidate_handles();
+  size_t index = iter - begin();
+  size_t old_size = size_;
+  if (index < size_ - index) {
+    prepend_elements(count, construct);
+    std::rotate(begin(), begin() + count, begin() + count + index);
+  } else {
+    append_elements(count, construct);
+    std::rotate(begin() + index, begin() + old_size, end());
+  }
+  return begin() + index;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <std::ranges::input_range Range>
+void Deque<T, Allocator, BucketPolicy>::append_range(Range&& range) {
+  if constexpr (std::ranges::forward_range<Range> ||
+                std::ranges::sized_range<Range>) {
+    size_t count = std::ranges::distance(range);
+    if constexpr (kInlineStorage) {
+      if (moves_inline_elements(count)) {
+        Deque copy(alloc_);
+        copy.append_range(std::forward<Range>(range));
+        auto element = std::make_move_iterator(copy.begin());
+        append_elements(count, [&](T* destination, size_t length) {
+          element = construct_range(destination, length, element);
+        });
+        return;
+      }
+    }
+    auto element = std::ranges::begin(range);
+    append_elements(count, [&](T* destination, size_t length) {
+      element = construct_range(destination, length, element);
+    });
+  } else {
+    for (auto&& element : range) {
+      emplace_back(std::forward<decltype(element)>(element));
+    }
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <std::ranges::input_range Range>
+void Deque<T, Allocator, BucketPolicy>::prepend_range(Range&& range) {
+  if constexpr (std::ranges::forward_range<Range> ||
+                std::ranges::sized_range<Range>) {
+    size_t count = std::ranges::distance(range);
+    if constexpr (kInlineStorage) {
+      if (moves_inline_elements(count)) {
+        Deque copy(alloc_);
+        copy.append_range(std::forward<Range>(range));
+        auto element = std::make_move_iterator(copy.begin());
+        prepend_elements(count, [&](T* destination, size_t length) {
+          element = construct_range(destination, length, element);
+        });
+        return;
+      }
+    }
+    auto element = std::ranges::begin(range);
+    prepend_elements(count, [&](T* destination, size_t length) {
+      element = construct_range(destination, length, element);
+    });
   } else {
-    auto iter_2 = end() - 1;
-    T last_element = *iter_2;
-    *iter_2 = value;
-    while (iter_2 > iter) {
-      std::swap(*(iter_2 - 1), *iter_2);
-      --iter_2;
+    size_t count = 0;
+    for (auto&& element : range) {
+      emplace_front(std::forward<decltype(element)>(element));
+      ++count;
     }
-    push_back(last_element);
-    std::swap(*(end() - 2), *(end() - 1));
+    std::reverse(begin(), begin() + count);
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename Function>
+void Deque<T, Allocator, BucketPolicy>::append_segments(size_t count,
+                                                        Function function) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "appended segments are filled as raw storage");
+  append_elements(count, [&](T* destination, size_t length) {
+    function(std::span<T>(destination, length));
+  });
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename Function>
+void Deque<T, Allocator, BucketPolicy>::prepend_segments(size_t count,
+                                                         Function function) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "prepended segments are filled as raw storage");
+  prepend_elements(count, [&](T* destination, size_t length) {
+    function(std::span<T>(destination, length));
+  });
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename... Arguments>
+typename Deque<T, Allocator, BucketPolicy>::iterator
+Deque<T, Allocator, BucketPolicy>::emplace(Deque::iterator iter,
+                                           Arguments&&... args) {
+  size_t index = iter - begin();
+  if (index == 0) {
+    emplace_front(std::forward<Arguments>(args)...);
+    return begin();
+  }
+  if (index == size_) {
+    emplace_back(std::forward<Arguments>(args)...);
+    return end() - 1;
   }
+  T value(std::forward<Arguments>(args)...);
+  invalidate_handles();
+  if (index < size_ - index) {
+    emplace_front(std::move((*this)[0]));
+    move_elements(2, index - 1, 1);
+  } else {
+    emplace_back(std::move((*this)[size_ - 1]));
+    move_elements(index, size_ - index - 2, index + 1);
+  }
+  (*this)[index] = std::move(value);
+  return begin() + index;
 }
 
-template <typename T, typename Allocator>
-typename Deque<T, Allocator>::const_reverse_iterator
-Deque<T, Allocator>::crend() const {
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::const_reverse_iterator
+Deque<T, Allocator, BucketPolicy>::crend() const {
   return std::make_reverse_iterator(cbegin());
 }
 
-template <typename T, typename Allocator>
-typename Deque<T, Allocator>::const_reverse_iterator
-Deque<T, Allocator>::crbegin() const {
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::const_reverse_iterator
+Deque<T, Allocator, BucketPolicy>::crbegin() const {
   return std::make_reverse_iterator(cend());
 }
 
-template <typename T, typename Allocator>
-typename Deque<T, Allocator>::reverse_iterator Deque<T, Allocator>::rend() {
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::reverse_iterator
+Deque<T, Allocator, BucketPolicy>::rend() {
   return std::make_reverse_iterator(begin());
 }
 
-template <typename T, typename Allocator>
-typename Deque<T, Allocator>::reverse_iterator Deque<T, Allocator>::rbegin() {
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::reverse_iterator
+Deque<T, Allocator, BucketPolicy>::rbegin() {
   return std::make_reverse_iterator(end());
 }
 
-template <typename T, typename Allocator>
-typename Deque<T, Allocator>::const_iterator Deque<T, Allocator>::cend() const {
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::const_iterator
+Deque<T, Allocator, BucketPolicy>::cend() const {
   if (empty()) {
-    return const_iterator(container_, last_element_bucket_,
-                          last_element_position_);
+    return const_iterator();
   }
-  return const_iterator(container_, last_element_bucket_,
-                        last_element_position_ + 1);
+  size_t end_offset =
+      (last_element_bucket_ << kBucketShift) + last_element_position_ + 1;
+  return const_iterator(container_ + (end_offset >> kBucketShift),
+                        end_offset & kBucketMask);
 }
 
-template <typename T, typename Allocator>
-typename Deque<T, Allocator>::iterator Deque<T, Allocator>::end() {
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::iterator
+Deque<T, Allocator, BucketPolicy>::end() {
   if (empty()) {
-    return iterator(container_, last_element_bucket_, last_element_position_);
+    return iterator();
   }
-  return iterator(container_, last_element_bucket_, last_element_position_ + 1);
+  size_t end_offset =
+      (last_element_bucket_ << kBucketShift) + last_element_position_ + 1;
+  return iterator(container_ + (end_offset >> kBucketShift),
+                  end_offset & kBucketMask);
 }
 
-template <typename T, typename Allocator>
-typename Deque<T, Allocator>::const_iterator Deque<T, Allocator>::cbegin()
-    const {
-  return const_iterator(container_, first_element_bucket_,
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::const_iterator
+Deque<T, Allocator, BucketPolicy>::cbegin() const {
+  if (empty()) {
+    return const_iterator();
+  }
+  return const_iterator(container_ + first_element_bucket_,
                         first_element_position_);
 }
 
-template <typename T, typename Allocator>
-typename Deque<T, Allocator>::iterator Deque<T, Allocator>::begin() {
-  return iterator(container_, first_element_bucket_, first_element_position_);
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::iterator
+Deque<T, Allocator, BucketPolicy>::begin() {
+  if (empty()) {
+    return iterator();
+  }
+  return iterator(container_ + first_element_bucket_, first_element_position_);
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-typename Deque<T, Allocator>::template Iterator<IsConst>::reference
-Deque<T, Allocator>::Iterator<IsConst>::operator*() const {
-  return ptr_[bucket_number_][position_];
+typename Deque<T, Allocator, BucketPolicy>::template Iterator<
+    IsConst>::reference
+Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator*() const {
+  return *cur_;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-bool Deque<T, Allocator>::Iterator<IsConst>::operator==(
-    const Deque<T, Allocator>::Iterator<IsConst>& other) const {
-  return bucket_number_ * kBucketSize + position_ ==
-         other.bucket_number_ * kBucketSize + other.position_;
+bool Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator==(
+    const Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>& other) const {
+  return cur_ == other.cur_;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-bool Deque<T, Allocator>::Iterator<IsConst>::operator<(
-    const Deque<T, Allocator>::Iterator<IsConst>& other) const {
-  return bucket_number_ * kBucketSize + position_ <
-         other.bucket_number_ * kBucketSize + other.position_;
+bool Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator<(
+    const Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>& other) const {
+  return node_ == other.node_ ? cur_ < other.cur_ : node_ < other.node_;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-bool Deque<T, Allocator>::Iterator<IsConst>::operator>(
-    const Deque<T, Allocator>::Iterator<IsConst>& other) const {
+bool Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator>(
+    const Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>& other) const {
   return other < *this;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-bool Deque<T, Allocator>::Iterator<IsConst>::operator>=(
-    const Deque<T, Allocator>::Iterator<IsConst>& other) const {
+bool Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator>=(
+    const Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>& other) const {
   return !(*this < other);
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-bool Deque<T, Allocator>::Iterator<IsConst>::operator<=(
-    const Deque<T, Allocator>::Iterator<IsConst>& other) const {
+bool Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator<=(
+    const Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>& other) const {
   return !(*this > other);
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-bool Deque<T, Allocator>::Iterator<IsConst>::operator!=(
-    const Deque<T, Allocator>::Iterator<IsConst>& other) const {
+bool Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator!=(
+    const Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>& other) const {
   return !(*this == other);
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-typename Deque<T, Allocator>::template Iterator<IsConst>&
-Deque<T, Allocator>::Iterator<IsConst>::operator+=(int number) {
-  if (position_ + number < kBucketSize) {
-    position_ += number;
+typename Deque<T, Allocator, BucketPolicy>::template Iterator<IsConst>&
+Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator+=(
+    difference_type number) {
+  difference_type offset = number + (cur_ - first_);
+  if (offset >= 0 && offset < static_cast<difference_type>(kBucketSize)) {
+    cur_ += number;
   } else {
-    number -= kBucketSize - position_;
-    bucket_number_ += 1 + number / kBucketSize;
-    position_ = number % kBucketSize;
+    set_node(node_ + (offset >> kBucketShift));
+    cur_ = first_ + (offset & kBucketMask);
   }
   return *this;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-typename Deque<T, Allocator>::template Iterator<IsConst>&
-Deque<T, Allocator>::Iterator<IsConst>::operator-=(int number) {
-  if (number <= position_) {
-    position_ -= number;
-  } else {
-    number -= position_ + 1;
-    bucket_number_ -= 1 + number / kBucketSize;
-    position_ = kBucketSize - 1 - number % kBucketSize;
-  }
-  return *this;
+typename Deque<T, Allocator, BucketPolicy>::template Iterator<IsConst>&
+Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator-=(
+    difference_type number) {
+  return *this += -number;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-typename Deque<T, Allocator>::template Iterator<IsConst>
-Deque<T, Allocator>::Iterator<IsConst>::operator-(int number) const {
+typename Deque<T, Allocator, BucketPolicy>::template Iterator<IsConst>
+Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator-(
+    difference_type number) const {
   auto tmp = *this;
   tmp -= number;
   return tmp;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-typename Deque<T, Allocator>::template Iterator<IsConst>
-Deque<T, Allocator>::Iterator<IsConst>::operator+(int number) const {
+typename Deque<T, Allocator, BucketPolicy>::template Iterator<IsConst>
+Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator+(
+    difference_type number) const {
   auto tmp = *this;
   tmp += number;
   return tmp;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-typename Deque<T, Allocator>::template Iterator<IsConst>
-Deque<T, Allocator>::Iterator<IsConst>::operator--(int) {
+typename Deque<T, Allocator, BucketPolicy>::template Iterator<IsConst>
+Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator--(int) {
   Iterator<IsConst> tmp = *this;
   --(*this);
   return tmp;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-typename Deque<T, Allocator>::template Iterator<IsConst>
-Deque<T, Allocator>::Iterator<IsConst>::operator++(int) {
+typename Deque<T, Allocator, BucketPolicy>::template Iterator<IsConst>
+Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator++(int) {
   Iterator<IsConst> tmp = *this;
   ++(*this);
   return tmp;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-typename Deque<T, Allocator>::template Iterator<IsConst>&
-Deque<T, Allocator>::Iterator<IsConst>::operator--() {
-  if (position_ != 0) {
-    --position_;
-  } else {
-    position_ = kBucketSize - 1;
-    --bucket_number_;
+typename Deque<T, Allocator, BucketPolicy>::template Iterator<IsConst>&
+Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator--() {
+  if (cur_ == first_) {
+    set_node(node_ - 1);
+    cur_ = first_ + kBucketSize;
   }
+  --cur_;
   return *this;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-typename Deque<T, Allocator>::template Iterator<IsConst>&
-Deque<T, Allocator>::Iterator<IsConst>::operator++() {
-  if (position_ != kBucketSize - 1) {
-    ++position_;
-  } else {
-    position_ = 0;
-    ++bucket_number_;
+typename Deque<T, Allocator, BucketPolicy>::template Iterator<IsConst>&
+Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator++() {
+  if (++cur_ == first_ + kBucketSize) {
+    set_node(node_ + 1);
+    cur_ = first_;
   }
   return *this;
 }
 
-template <typename T, typename Allocator>
+template <typename T, typename Allocator, typename BucketPolicy>
 template <bool IsConst>
-Deque<T, Allocator>::Iterator<IsConst>::Iterator(T** ptr, size_t bucket_number,
-                                                 size_t position)
-    : ptr_(ptr),
-      bucket_number_(static_cast<int>(bucket_number)),
-      position_(static_cast<int>(position)) {}
\ No newline at end of file
+Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::Iterator(
+    T** node, size_t position)
+    : node_(node), first_(*node), cur_(first_ + position) {}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+void Deque<T, Allocator, BucketPolicy>::Iterator<IsConst>::set_node(
+    T** node) {
+  node_ = node;
+  first_ = *node;
+  if (first_ != nullptr) {
+    prefetch(node[1], kPrefetchBytes);
+  }
+}
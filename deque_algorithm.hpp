@@ -0,0 +1,69 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+#include "deque.hpp"
+
+template <typename T, typename Allocator, typename BucketPolicy,
+          typename OutputIt>
+OutputIt segmented_copy(const Deque<T, Allocator, BucketPolicy>& deque,
+                        OutputIt out) {
+  deque.for_each_segment([&](std::span<const T> segment) {
+    out = std::copy(segment.begin(), segment.end(), out);
+  });
+  return out;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void segmented_fill(Deque<T, Allocator, BucketPolicy>& deque, const T& value) {
+  deque.for_each_segment([&](std::span<T> segment) {
+    std::fill(segment.begin(), segment.end(), value);
+  });
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename Deque<T, Allocator, BucketPolicy>::const_iterator segmented_find(
+    const Deque<T, Allocator, BucketPolicy>& deque, const T& value) {
+  size_t index = 0;
+  for (size_t i = 0; i < deque.segment_count(); ++i) {
+    std::span<const T> segment = deque.segment(i);
+    auto found = std::find(segment.begin(), segment.end(), value);
+    index += found - segment.begin();
+    if (found != segment.end()) {
+      break;
+    }
+  }
+  return deque.cbegin() + index;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy,
+          typename Value, typename BinaryOperation = std::plus<>>
+Value segmented_accumulate(const Deque<T, Allocator, BucketPolicy>& deque,
+                           Value init,
+                           BinaryOperation operation = BinaryOperation()) {
+  deque.for_each_segment([&](std::span<const T> segment) {
+    init = std::accumulate(segment.begin(), segment.end(), std::move(init),
+                           operation);
+  });
+  return init;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy,
+          typename OutputIt, typename UnaryOperation>
+OutputIt segmented_transform(const Deque<T, Allocator, BucketPolicy>& deque,
+                             OutputIt out, UnaryOperation operation) {
+  deque.for_each_segment([&](std::span<const T> segment) {
+    out = std::transform(segment.begin(), segment.end(), out, operation);
+  });
+  return out;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy,
+          typename UnaryOperation>
+void segmented_transform(Deque<T, Allocator, BucketPolicy>& deque,
+                         UnaryOperation operation) {
+  deque.for_each_segment([&](std::span<T> segment) {
+    std::transform(segment.begin(), segment.end(), segment.begin(), operation);
+  });
+}
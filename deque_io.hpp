@@ -0,0 +1,174 @@
+#pragma once
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include "deque.hpp"
+
+struct DequeFileHeader {
+  uint64_t magic;
+  uint64_t element_size;
+  uint64_t count;
+};
+
+inline constexpr uint64_t kDequeFileMagic = 0x31657571654470ae;
+inline constexpr size_t kIovecBatch = IOV_MAX;
+inline constexpr size_t kRestoreBatchBytes = size_t{1} << 24;
+
+inline void write_iovecs(int fd, std::vector<iovec>& iovecs) {
+  size_t index = 0;
+  while (index < iovecs.size()) {
+    ssize_t written = ::writev(
+        fd, iovecs.data() + index,
+        static_cast<int>(std::min(iovecs.size() - index, kIovecBatch)));
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error(errno, std::generic_category(), "writev");
+    }
+    size_t bytes = written;
+    while (index < iovecs.size() && bytes >= iovecs[index].iov_len) {
+      bytes -= iovecs[index].iov_len;
+      ++index;
+    }
+    if (bytes != 0) {
+      iovecs[index].iov_base =
+          static_cast<char*>(iovecs[index].iov_base) + bytes;
+      iovecs[index].iov_len -= bytes;
+    }
+  }
+  iovecs.clear();
+}
+
+inline void read_iovecs(int fd, std::vector<iovec>& iovecs) {
+  size_t index = 0;
+  while (index < iovecs.size()) {
+    ssize_t received = ::readv(
+        fd, iovecs.data() + index,
+        static_cast<int>(std::min(iovecs.size() - index, kIovecBatch)));
+    if (received < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error(errno, std::generic_category(), "readv");
+    }
+    size_t bytes = received;
+    if (bytes == 0) {
+      throw std::runtime_error("Unexpected end of deque stream");
+    }
+    while (index < iovecs.size() && bytes >= iovecs[index].iov_len) {
+      bytes -= iovecs[index].iov_len;
+      ++index;
+    }
+    if (bytes != 0) {
+      iovecs[index].iov_base =
+          static_cast<char*>(iovecs[index].iov_base) + bytes;
+      iovecs[index].iov_len -= bytes;
+    }
+  }
+  iovecs.clear();
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void save_deque(const Deque<T, Allocator, BucketPolicy>& deque, int fd) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "elements are written as raw bytes");
+  DequeFileHeader header{kDequeFileMagic, sizeof(T), deque.size()};
+  std::vector<iovec> iovecs;
+  iovecs.reserve(std::min(deque.segment_count() + 1, kIovecBatch));
+  iovecs.push_back({&header, sizeof(header)});
+  deque.for_each_segment([&](std::span<const T> segment) {
+    iovecs.push_back({const_cast<T*>(segment.data()), segment.size_bytes()});
+    if (iovecs.size() == kIovecBatch) {
+      write_iovecs(fd, iovecs);
+    }
+  });
+  write_iovecs(fd, iovecs);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void restore_back(Deque<T, Allocator, BucketPolicy>& deque, int fd,
+                  size_t count) {
+  std::vector<iovec> iovecs;
+  iovecs.reserve(std::min(count, kIovecBatch));
+  size_t remaining = count;
+  deque.append_segments(count, [&](std::span<T> segment) {
+    iovecs.push_back({segment.data(), segment.size_bytes()});
+    remaining -= segment.size();
+    if (iovecs.size() == kIovecBatch || remaining == 0) {
+      read_iovecs(fd, iovecs);
+    }
+  });
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void restore_front(Deque<T, Allocator, BucketPolicy>& deque, int fd,
+                   size_t count) {
+  std::vector<iovec> iovecs;
+  iovecs.reserve(std::min(count, kIovecBatch));
+  size_t remaining = count;
+  deque.prepend_segments(count, [&](std::span<T> segment) {
+    iovecs.push_back({segment.data(), segment.size_bytes()});
+    remaining -= segment.size();
+    if (iovecs.size() == kIovecBatch || remaining == 0) {
+      read_iovecs(fd, iovecs);
+    }
+  });
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void load_deque(Deque<T, Allocator, BucketPolicy>& deque, int fd) {
+  DequeFileHeader header{};
+  std::vector<iovec> iovecs{{&header, sizeof(header)}};
+  read_iovecs(fd, iovecs);
+  if (header.magic != kDequeFileMagic || header.element_size != sizeof(T)) {
+    throw std::runtime_error("Incompatible deque file");
+  }
+  struct stat status {};
+  if (::fstat(fd, &status) == 0 && S_ISREG(status.st_mode)) {
+    off_t position = ::lseek(fd, 0, SEEK_CUR);
+    if (position >= 0 &&
+        (position > status.st_size ||
+         header.count > static_cast<uint64_t>(status.st_size - position) /
+                            sizeof(T))) {
+      throw std::runtime_error("Truncated deque file");
+    }
+  }
+  deque.pop_back(deque.size());
+  constexpr size_t kBatch = std::max<size_t>(kRestoreBatchBytes / sizeof(T), 1);
+  for (uint64_t remaining = header.count; remaining != 0;) {
+    size_t batch = std::min<uint64_t>(remaining, kBatch);
+    restore_back(deque, fd, batch);
+    remaining -= batch;
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+size_t spill_front(Deque<T, Allocator, BucketPolicy>& deque, int fd,
+                   size_t count) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "elements are written as raw bytes");
+  count = std::min(count, deque.size());
+  std::vector<iovec> iovecs;
+  size_t collected = 0;
+  for (size_t i = 0; collected < count; ++i) {
+    std::span<T> segment = deque.segment(i);
+    size_t length = std::min(segment.size(), count - collected);
+    iovecs.push_back({segment.data(), length * sizeof(T)});
+    collected += length;
+    if (iovecs.size() == kIovecBatch) {
+      write_iovecs(fd, iovecs);
+    }
+  }
+  write_iovecs(fd, iovecs);
+  deque.pop_front(count);
+  return count;
+}
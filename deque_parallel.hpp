@@ -0,0 +1,372 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "deque.hpp"
+
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t thread_count);
+  ThreadPool(const ThreadPool& other) = delete;
+  ThreadPool& operator=(const ThreadPool& other) = delete;
+  ~ThreadPool();
+
+  size_t concurrency() const;
+  void run(size_t task_count, const std::function<void(size_t)>& function);
+  static const std::shared_ptr<ThreadPool>& default_pool();
+
+ private:
+  void worker_loop();
+  void execute_tasks();
+
+  static thread_local const ThreadPool* current_pool_;
+
+  std::mutex run_mutex_;
+  std::mutex mutex_;
+  std::condition_variable work_ready_;
+  std::condition_variable work_finished_;
+  const std::function<void(size_t)>* function_ = nullptr;
+  size_t task_count_ = 0;
+  std::atomic<size_t> next_task_{0};
+  size_t busy_workers_ = 0;
+  size_t generation_ = 0;
+  bool stopping_ = false;
+  std::exception_ptr failure_;
+  std::vector<std::jthread> workers_;
+};
+
+inline thread_local const ThreadPool* ThreadPool::current_pool_ = nullptr;
+
+inline ThreadPool::ThreadPool(size_t thread_count) {
+  thread_count = std::max<size_t>(thread_count, 1);
+  workers_.reserve(thread_count - 1);
+  for (size_t i = 1; i < thread_count; ++i) {
+    workers_.emplace_back([this] { worker_loop(); });
+  }
+}
+
+inline ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_ready_.notify_all();
+  workers_.clear();
+}
+
+inline size_t ThreadPool::concurrency() const { return workers_.size() + 1; }
+
+inline void ThreadPool::run(size_t task_count,
+                            const std::function<void(size_t)>& function) {
+  if (task_count <= 1 || workers_.empty() || current_pool_ == this) {
+    for (size_t task = 0; task < task_count; ++task) {
+      function(task);
+    }
+    return;
+  }
+  std::lock_guard<std::mutex> run_lock(run_mutex_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    function_ = &function;
+    task_count_ = task_count;
+    next_task_ = 0;
+    busy_workers_ = workers_.size();
+    ++generation_;
+  }
+  work_ready_.notify_all();
+  const ThreadPool* previous_pool = std::exchange(current_pool_, this);
+  execute_tasks();
+  current_pool_ = previous_pool;
+  std::exception_ptr failure;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    work_finished_.wait(lock, [this] { return busy_workers_ == 0; });
+    function_ = nullptr;
+    failure = std::exchange(failure_, nullptr);
+  }
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+}
+
+inline const std::shared_ptr<ThreadPool>& ThreadPool::default_pool() {
+  static const std::shared_ptr<ThreadPool> pool = std::make_shared<ThreadPool>(
+      std::max<size_t>(std::thread::hardware_concurrency(), 1));
+  return pool;
+}
+
+inline void ThreadPool::worker_loop() {
+  current_pool_ = this;
+  size_t generation = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_ready_.wait(
+        lock, [&] { return stopping_ || generation_ != generation; });
+    if (stopping_) {
+      return;
+    }
+    generation = generation_;
+    lock.unlock();
+    execute_tasks();
+    lock.lock();
+    if (--busy_workers_ == 0) {
+      work_finished_.notify_one();
+    }
+  }
+}
+
+inline void ThreadPool::execute_tasks() {
+  try {
+    for (size_t task = next_task_++; task < task_count_;
+         task = next_task_++) {
+      (*function_)(task);
+    }
+  } catch (...) {
+    next_task_ = task_count_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!failure_) {
+      failure_ = std::current_exception();
+    }
+  }
+}
+
+class ThreadExecutor {
+ public:
+  ThreadExecutor();
+  explicit ThreadExecutor(size_t thread_count);
+
+  size_t concurrency() const;
+
+  template <typename Function>
+  void run(size_t task_count, Function function) const;
+
+ private:
+  std::shared_ptr<ThreadPool> pool_;
+};
+
+inline ThreadExecutor::ThreadExecutor() : pool_(ThreadPool::default_pool()) {}
+
+inline ThreadExecutor::ThreadExecutor(size_t thread_count)
+    : pool_(std::make_shared<ThreadPool>(thread_count)) {}
+
+inline size_t ThreadExecutor::concurrency() const {
+  return pool_->concurrency();
+}
+
+template <typename Function>
+void ThreadExecutor::run(size_t task_count, Function function) const {
+  pool_->run(task_count, std::function<void(size_t)>(std::ref(function)));
+}
+
+struct SegmentRange {
+  size_t first_segment;
+  size_t last_segment;
+  size_t first_index;
+  size_t last_index;
+};
+
+inline constexpr size_t kTasksPerThread = 4;
+
+template <typename Container, typename Executor>
+std::vector<SegmentRange> partition_segments(const Container& deque,
+                                             const Executor& executor) {
+  size_t segment_count = deque.segment_count();
+  size_t task_count = std::min(segment_count,
+                               kTasksPerThread * executor.concurrency());
+  std::vector<SegmentRange> ranges;
+  ranges.reserve(task_count);
+  size_t index = 0;
+  size_t segment = 0;
+  for (size_t task = 0; task < task_count; ++task) {
+    size_t last_segment = (task + 1) * segment_count / task_count;
+    SegmentRange range{segment, last_segment, index, index};
+    for (; segment < last_segment; ++segment) {
+      index += deque.segment(segment).size();
+    }
+    range.last_index = index;
+    ranges.push_back(range);
+  }
+  return ranges;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy,
+          typename Function, typename Executor = ThreadExecutor>
+void parallel_for_each(Deque<T, Allocator, BucketPolicy>& deque,
+                       Function function, const Executor& executor = {}) {
+  std::vector<SegmentRange> ranges = partition_segments(deque, executor);
+  executor.run(ranges.size(), [&](size_t task) {
+    for (size_t i = ranges[task].first_segment; i < ranges[task].last_segment;
+         ++i) {
+      std::span<T> segment = deque.segment(i);
+      std::for_each(segment.begin(), segment.end(), function);
+    }
+  });
+}
+
+template <typename T, typename Allocator, typename BucketPolicy,
+          typename UnaryOperation, typename Executor = ThreadExecutor>
+void parallel_transform(Deque<T, Allocator, BucketPolicy>& deque,
+                        UnaryOperation operation,
+                        const Executor& executor = {}) {
+  std::vector<SegmentRange> ranges = partition_segments(deque, executor);
+  executor.run(ranges.size(), [&](size_t task) {
+    for (size_t i = ranges[task].first_segment; i < ranges[task].last_segment;
+         ++i) {
+      std::span<T> segment = deque.segment(i);
+      std::transform(segment.begin(), segment.end(), segment.begin(),
+                     operation);
+    }
+  });
+}
+
+template <typename T, typename Allocator, typename BucketPolicy,
+          std::random_access_iterator OutputIt, typename UnaryOperation,
+          typename Executor = ThreadExecutor>
+OutputIt parallel_transform(const Deque<T, Allocator, BucketPolicy>& deque,
+                            OutputIt out, UnaryOperation operation,
+                            const Executor& executor = {}) {
+  std::vector<SegmentRange> ranges = partition_segments(deque, executor);
+  executor.run(ranges.size(), [&](size_t task) {
+    OutputIt destination = out + ranges[task].first_index;
+    for (size_t i = ranges[task].first_segment; i < ranges[task].last_segment;
+         ++i) {
+      std::span<const T> segment = deque.segment(i);
+      destination = std::transform(segment.begin(), segment.end(),
+                                   destination, operation);
+    }
+  });
+  return out + deque.size();
+}
+
+template <typename T, typename Allocator, typename BucketPolicy,
+          typename Value, typename BinaryOperation = std::plus<>,
+          typename Executor = ThreadExecutor>
+Value parallel_reduce(const Deque<T, Allocator, BucketPolicy>& deque,
+                      Value init, BinaryOperation operation = {},
+                      const Executor& executor = {}) {
+  std::vector<SegmentRange> ranges = partition_segments(deque, executor);
+  std::vector<Value> partials(ranges.size(), init);
+  executor.run(ranges.size(), [&](size_t task) {
+    std::span<const T> first = deque.segment(ranges[task].first_segment);
+    Value partial(first.front());
+    partial = std::accumulate(first.begin() + 1, first.end(),
+                              std::move(partial), operation);
+    for (size_t i = ranges[task].first_segment + 1;
+         i < ranges[task].last_segment; ++i) {
+      std::span<const T> segment = deque.segment(i);
+      partial = std::accumulate(segment.begin(), segment.end(),
+                                std::move(partial), operation);
+    }
+    partials[task] = std::move(partial);
+  });
+  for (size_t task = 0; task < ranges.size(); ++task) {
+    init = operation(std::move(init), std::move(partials[task]));
+  }
+  return init;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy,
+          typename Predicate, typename Executor = ThreadExecutor>
+typename Deque<T, Allocator, BucketPolicy>::const_iterator parallel_find_if(
+    const Deque<T, Allocator, BucketPolicy>& deque, Predicate predicate,
+    const Executor& executor = {}) {
+  std::vector<SegmentRange> ranges = partition_segments(deque, executor);
+  std::atomic<size_t> found{deque.size()};
+  executor.run(ranges.size(), [&](size_t task) {
+    size_t index = ranges[task].first_index;
+    for (size_t i = ranges[task].first_segment; i < ranges[task].last_segment;
+         ++i) {
+      if (index >= found.load(std::memory_order_relaxed)) {
+        return;
+      }
+      std::span<const T> segment = deque.segment(i);
+      auto match = std::find_if(segment.begin(), segment.end(), predicate);
+      if (match != segment.end()) {
+        size_t match_index = index + (match - segment.begin());
+        size_t current = found.load(std::memory_order_relaxed);
+        while (match_index < current &&
+               !found.compare_exchange_weak(current, match_index,
+                                            std::memory_order_relaxed)) {
+        }
+        return;
+      }
+      index += segment.size();
+    }
+  });
+  return deque.cbegin() + found.load();
+}
+
+template <typename T, typename Allocator, typename BucketPolicy,
+          typename Compare = std::less<>, typename Executor = ThreadExecutor>
+void parallel_sort(Deque<T, Allocator, BucketPolicy>& deque,
+                   Compare compare = {}, const Executor& executor = {}) {
+  std::vector<SegmentRange> ranges = partition_segments(deque, executor);
+  if (ranges.empty()) {
+    return;
+  }
+  std::vector<size_t> bounds;
+  bounds.reserve(ranges.size() + 1);
+  for (const SegmentRange& range : ranges) {
+    bounds.push_back(range.first_index);
+  }
+  bounds.push_back(deque.size());
+  executor.run(ranges.size(), [&](size_t task) {
+    std::sort(deque.begin() + bounds[task], deque.begin() + bounds[task + 1],
+              compare);
+  });
+  if (ranges.size() == 1) {
+    return;
+  }
+  std::vector<T> buffer;
+  buffer.reserve(deque.size());
+  deque.for_each_segment([&](std::span<T> segment) {
+    buffer.insert(buffer.end(), std::make_move_iterator(segment.begin()),
+                  std::make_move_iterator(segment.end()));
+  });
+  bool in_buffer = true;
+  auto merge_pass = [&](auto source, auto destination) {
+    size_t run_count = bounds.size() - 1;
+    executor.run((run_count + 1) / 2, [&](size_t pair) {
+      size_t first = bounds[2 * pair];
+      size_t middle = bounds[std::min(2 * pair + 1, run_count)];
+      size_t last = bounds[std::min(2 * pair + 2, run_count)];
+      std::merge(std::make_move_iterator(source + first),
+                 std::make_move_iterator(source + middle),
+                 std::make_move_iterator(source + middle),
+                 std::make_move_iterator(source + last), destination + first,
+                 compare);
+    });
+    std::vector<size_t> merged;
+    merged.reserve(run_count / 2 + 2);
+    for (size_t i = 0; i < run_count; i += 2) {
+      merged.push_back(bounds[i]);
+    }
+    merged.push_back(bounds.back());
+    bounds = std::move(merged);
+  };
+  while (bounds.size() > 2) {
+    if (in_buffer) {
+      merge_pass(buffer.begin(), deque.begin());
+    } else {
+      merge_pass(deque.begin(), buffer.begin());
+    }
+    in_buffer = !in_buffer;
+  }
+  if (in_buffer) {
+    std::vector<SegmentRange> copies = partition_segments(deque, executor);
+    executor.run(copies.size(), [&](size_t task) {
+      std::move(buffer.begin() + copies[task].first_index,
+                buffer.begin() + copies[task].last_index,
+                deque.begin() + copies[task].first_index);
+    });
+  }
+}
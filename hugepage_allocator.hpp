@@ -0,0 +1,317 @@
+#pragma once
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#include "deque.hpp"
+
+#if __has_include(<linux/mempolicy.h>) && defined(SYS_mbind)
+#include <linux/mempolicy.h>
+#define DEQUE_HAS_MBIND 1
+#endif
+
+inline constexpr size_t kHugePageSize = size_t{2} << 20;
+
+struct HugePageOptions {
+  int numa_node = -1;
+  bool use_hugetlb = true;
+  size_t region_bytes = kHugePageSize;
+};
+
+struct HugePageArenaStats {
+  size_t regions = 0;
+  size_t hugetlb_regions = 0;
+  size_t advised_regions = 0;
+  size_t bound_regions = 0;
+  size_t mapped_bytes = 0;
+};
+
+class HugePageArena {
+ public:
+  explicit HugePageArena(HugePageOptions options = {});
+  HugePageArena(const HugePageArena& other) = delete;
+  HugePageArena& operator=(const HugePageArena& other) = delete;
+  ~HugePageArena();
+
+  void* allocate(size_t bytes, size_t alignment);
+  void deallocate(void* pointer, size_t bytes, size_t alignment);
+  HugePageArenaStats stats() const;
+  static const std::shared_ptr<HugePageArena>& default_arena();
+
+  static constexpr size_t kBlockAlignment = 64;
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  struct Mapping {
+    void* address;
+    size_t bytes;
+    bool hugetlb = false;
+    bool advised = false;
+    bool bound = false;
+  };
+
+  static size_t block_bytes(size_t bytes);
+  bool is_large(size_t bytes) const;
+  Mapping map_region(size_t bytes);
+  void unmap_region(const Mapping& mapping);
+  bool bind_region(void* region, size_t bytes);
+  void* carve(size_t bytes);
+
+  HugePageOptions options_;
+  mutable std::mutex mutex_;
+  std::vector<Mapping> regions_;
+  std::unordered_map<void*, Mapping> large_mappings_;
+  std::unordered_map<size_t, FreeBlock*> free_blocks_;
+  char* region_cursor_ = nullptr;
+  char* region_end_ = nullptr;
+  HugePageArenaStats stats_;
+};
+
+inline HugePageArena::HugePageArena(HugePageOptions options)
+    : options_(options) {
+  options_.region_bytes =
+      (std::max(options_.region_bytes, kHugePageSize) + kHugePageSize - 1) &
+      ~(kHugePageSize - 1);
+}
+
+inline HugePageArena::~HugePageArena() {
+  for (const Mapping& region : regions_) {
+    ::munmap(region.address, region.bytes);
+  }
+  for (const auto& [address, mapping] : large_mappings_) {
+    ::munmap(address, mapping.bytes);
+  }
+}
+
+inline void* HugePageArena::allocate(size_t bytes, size_t alignment) {
+  if (alignment > kBlockAlignment) {
+    return ::operator new(bytes, std::align_val_t(alignment));
+  }
+  bytes = block_bytes(bytes);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (is_large(bytes)) {
+    size_t mapped = (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    Mapping mapping = map_region(mapped);
+    large_mappings_.emplace(mapping.address, mapping);
+    return mapping.address;
+  }
+  auto free_list = free_blocks_.find(bytes);
+  if (free_list != free_blocks_.end() && free_list->second != nullptr) {
+    FreeBlock* block = free_list->second;
+    free_list->second = block->next;
+    return block;
+  }
+  return carve(bytes);
+}
+
+inline void HugePageArena::deallocate(void* pointer, size_t bytes,
+                                      size_t alignment) {
+  if (alignment > kBlockAlignment) {
+    ::operator delete(pointer, std::align_val_t(alignment));
+    return;
+  }
+  bytes = block_bytes(bytes);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (is_large(bytes)) {
+    auto mapping = large_mappings_.find(pointer);
+    if (mapping == large_mappings_.end()) {
+      std::fputs(
+          "HugePageArena: deallocating a large block this arena did not map\n",
+          stderr);
+      std::abort();
+    }
+    unmap_region(mapping->second);
+    large_mappings_.erase(mapping);
+    return;
+  }
+  FreeBlock*& head = free_blocks_[bytes];
+  head = ::new (pointer) FreeBlock{head};
+}
+
+inline HugePageArenaStats HugePageArena::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+inline const std::shared_ptr<HugePageArena>& HugePageArena::default_arena() {
+  static const std::shared_ptr<HugePageArena> arena =
+      std::make_shared<HugePageArena>();
+  return arena;
+}
+
+inline size_t HugePageArena::block_bytes(size_t bytes) {
+  return (std::max(bytes, size_t{1}) + kBlockAlignment - 1) &
+         ~(kBlockAlignment - 1);
+}
+
+inline bool HugePageArena::is_large(size_t bytes) const {
+  return bytes > options_.region_bytes / 4;
+}
+
+inline HugePageArena::Mapping HugePageArena::map_region(size_t bytes) {
+  void* region = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if (options_.use_hugetlb) {
+    region = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  }
+#endif
+  Mapping mapping{region, bytes};
+  if (region != MAP_FAILED) {
+    mapping.hugetlb = true;
+    ++stats_.hugetlb_regions;
+  } else {
+    size_t padded = bytes + kHugePageSize;
+    void* raw = ::mmap(nullptr, padded, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    char* begin = static_cast<char*>(raw);
+    char* aligned = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(begin) + kHugePageSize - 1) &
+        ~uintptr_t{kHugePageSize - 1});
+    if (aligned != begin) {
+      ::munmap(begin, aligned - begin);
+    }
+    if (aligned + bytes != begin + padded) {
+      ::munmap(aligned + bytes, begin + padded - (aligned + bytes));
+    }
+    mapping.address = aligned;
+#ifdef MADV_HUGEPAGE
+    if (::madvise(aligned, bytes, MADV_HUGEPAGE) == 0) {
+      mapping.advised = true;
+      ++stats_.advised_regions;
+    }
+#endif
+  }
+  if (bind_region(mapping.address, bytes)) {
+    mapping.bound = true;
+    ++stats_.bound_regions;
+  }
+  ++stats_.regions;
+  stats_.mapped_bytes += bytes;
+  return mapping;
+}
+
+inline void HugePageArena::unmap_region(const Mapping& mapping) {
+  ::munmap(mapping.address, mapping.bytes);
+  --stats_.regions;
+  stats_.hugetlb_regions -= mapping.hugetlb ? 1 : 0;
+  stats_.advised_regions -= mapping.advised ? 1 : 0;
+  stats_.bound_regions -= mapping.bound ? 1 : 0;
+  stats_.mapped_bytes -= mapping.bytes;
+}
+
+inline bool HugePageArena::bind_region([[maybe_unused]] void* region,
+                                       [[maybe_unused]] size_t bytes) {
+#ifdef DEQUE_HAS_MBIND
+  if (options_.numa_node < 0) {
+    return false;
+  }
+  constexpr size_t kWordBits = sizeof(unsigned long) * 8;
+  size_t node = options_.numa_node;
+  std::vector<unsigned long> node_mask(node / kWordBits + 1);
+  node_mask[node / kWordBits] = 1UL << (node % kWordBits);
+  return ::syscall(SYS_mbind, region, bytes, MPOL_BIND, node_mask.data(),
+                   node_mask.size() * kWordBits + 1, 0) == 0;
+#else
+  return false;
+#endif
+}
+
+inline void* HugePageArena::carve(size_t bytes) {
+  if (region_cursor_ == nullptr ||
+      static_cast<size_t>(region_end_ - region_cursor_) < bytes) {
+    Mapping region = map_region(options_.region_bytes);
+    region_cursor_ = static_cast<char*>(region.address);
+    region_end_ = region_cursor_ + options_.region_bytes;
+    regions_.push_back(region);
+  }
+  void* block = region_cursor_;
+  region_cursor_ += bytes;
+  return block;
+}
+
+template <typename T>
+class HugePageAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  HugePageAllocator();
+  explicit HugePageAllocator(HugePageOptions options);
+  explicit HugePageAllocator(std::shared_ptr<HugePageArena> arena);
+  template <typename U>
+  HugePageAllocator(const HugePageAllocator<U>& other);
+
+  T* allocate(size_t count);
+  void deallocate(T* pointer, size_t count);
+  const std::shared_ptr<HugePageArena>& arena() const;
+
+  template <typename U>
+  bool operator==(const HugePageAllocator<U>& other) const;
+
+ private:
+  std::shared_ptr<HugePageArena> arena_;
+};
+
+template <typename T>
+HugePageAllocator<T>::HugePageAllocator()
+    : arena_(HugePageArena::default_arena()) {}
+
+template <typename T>
+HugePageAllocator<T>::HugePageAllocator(HugePageOptions options)
+    : arena_(std::make_shared<HugePageArena>(options)) {}
+
+template <typename T>
+HugePageAllocator<T>::HugePageAllocator(std::shared_ptr<HugePageArena> arena)
+    : arena_(std::move(arena)) {}
+
+template <typename T>
+template <typename U>
+HugePageAllocator<T>::HugePageAllocator(const HugePageAllocator<U>& other)
+    : arena_(other.arena()) {}
+
+template <typename T>
+T* HugePageAllocator<T>::allocate(size_t count) {
+  if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+    throw std::bad_array_new_length();
+  }
+  return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+}
+
+template <typename T>
+void HugePageAllocator<T>::deallocate(T* pointer, size_t count) {
+  arena_->deallocate(pointer, count * sizeof(T), alignof(T));
+}
+
+template <typename T>
+const std::shared_ptr<HugePageArena>& HugePageAllocator<T>::arena() const {
+  return arena_;
+}
+
+template <typename T>
+template <typename U>
+bool HugePageAllocator<T>::operator==(const HugePageAllocator<U>& other) const {
+  return arena_ == other.arena();
+}
+
+template <typename T, typename BucketPolicy = DefaultBucketPolicy<T>>
+using HugePageDeque = Deque<T, HugePageAllocator<T>, BucketPolicy>;
@@ -0,0 +1,351 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "deque.hpp"
+
+template <typename T, typename BucketPolicy = DefaultBucketPolicy<T>>
+class MappedDeque {
+ public:
+  explicit MappedDeque(const std::string& path);
+  MappedDeque(const MappedDeque& other) = delete;
+  MappedDeque& operator=(const MappedDeque& other) = delete;
+  ~MappedDeque();
+
+  size_t size() const;
+  bool empty() const;
+  T& operator[](size_t ind);
+  const T& operator[](size_t ind) const;
+  T& at(size_t ind);
+  const T& at(size_t ind) const;
+  void push_back(const T& value);
+  void push_front(const T& value);
+  void pop_back();
+  void pop_front();
+  void sync();
+
+ private:
+  struct Header {
+    uint64_t magic;
+    uint64_t element_size;
+    uint64_t bucket_size;
+    uint64_t file_size;
+    uint64_t allocated_bytes;
+    uint64_t container_offset;
+    uint64_t first_element_offset;
+    uint64_t end_element_offset;
+  };
+
+  static constexpr size_t kBucketSize = BucketPolicy::kBucketSize;
+  static constexpr size_t kBucketShift = std::countr_zero(kBucketSize);
+  static constexpr size_t kBucketMask = kBucketSize - 1;
+  static constexpr size_t kBucketAlignment =
+      std::max(alignof(T), alignof(uint64_t));
+  static constexpr size_t kBucketBytes =
+      (kBucketSize * sizeof(T) + kBucketAlignment - 1) &
+      ~(kBucketAlignment - 1);
+  static constexpr size_t kInitialCapacity = 8;
+  static constexpr size_t kInitialFileSize = size_t{1} << 16;
+  static constexpr uint64_t kOrigin = (uint64_t{1} << 62) + kBucketSize / 2;
+  static constexpr uint64_t kMagic = 0x31657571654470ad;
+  static_assert(std::has_single_bit(kBucketSize),
+                "bucket size must be a power of two");
+  static_assert(std::is_trivially_copyable_v<T>,
+                "mapped elements are reused without deserialization");
+
+  void map_file(size_t size);
+  void close_file();
+  uint64_t allocate(size_t bytes, size_t alignment);
+  void reallocation();
+  T* install_bucket(uint64_t bucket_number);
+  uint64_t* slot(uint64_t bucket_number) const;
+  T* element(uint64_t offset) const;
+  void mark_dirty(uint64_t offset, size_t bytes);
+  void sync_range(uint64_t offset, size_t bytes);
+
+  int fd_ = -1;
+  char* base_ = nullptr;
+  Header* header_ = nullptr;
+  std::map<uint64_t, size_t> dirty_;
+  uint64_t last_dirty_bucket_ = 0;
+};
+
+template <typename T, typename BucketPolicy>
+MappedDeque<T, BucketPolicy>::MappedDeque(const std::string& path) {
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    throw std::system_error(errno, std::generic_category(), path);
+  }
+  try {
+    struct stat status {};
+    if (::fstat(fd_, &status) != 0) {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+    if (status.st_size == 0) {
+      if (::ftruncate(fd_, kInitialFileSize) != 0) {
+        throw std::system_error(errno, std::generic_category(), path);
+      }
+      map_file(kInitialFileSize);
+      *header_ = Header{kMagic,          sizeof(T), kBucketSize,
+                        kInitialFileSize, sizeof(Header), 0,
+                        kOrigin,          kOrigin};
+      return;
+    }
+    if (static_cast<size_t>(status.st_size) < sizeof(Header)) {
+      throw std::runtime_error("Incompatible deque file: " + path);
+    }
+    map_file(status.st_size);
+    if (header_->magic != kMagic || header_->element_size != sizeof(T) ||
+        header_->bucket_size != kBucketSize ||
+        header_->file_size > static_cast<uint64_t>(status.st_size)) {
+      throw std::runtime_error("Incompatible deque file: " + path);
+    }
+    header_->file_size = status.st_size;
+  } catch (...) {
+    close_file();
+    throw;
+  }
+}
+
+template <typename T, typename BucketPolicy>
+MappedDeque<T, BucketPolicy>::~MappedDeque() {
+  close_file();
+}
+
+template <typename T, typename BucketPolicy>
+void MappedDeque<T, BucketPolicy>::map_file(size_t size) {
+  void* base =
+      ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (base == MAP_FAILED) {
+    throw std::system_error(errno, std::generic_category(), "mmap");
+  }
+  base_ = static_cast<char*>(base);
+  header_ = reinterpret_cast<Header*>(base_);
+}
+
+template <typename T, typename BucketPolicy>
+void MappedDeque<T, BucketPolicy>::close_file() {
+  if (base_ != nullptr) {
+    ::munmap(base_, header_->file_size);
+    base_ = nullptr;
+    header_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+template <typename T, typename BucketPolicy>
+size_t MappedDeque<T, BucketPolicy>::size() const {
+  return header_->end_element_offset - header_->first_element_offset;
+}
+
+template <typename T, typename BucketPolicy>
+bool MappedDeque<T, BucketPolicy>::empty() const {
+  return header_->end_element_offset == header_->first_element_offset;
+}
+
+template <typename T, typename BucketPolicy>
+uint64_t* MappedDeque<T, BucketPolicy>::slot(uint64_t bucket_number) const {
+  uint64_t* container =
+      reinterpret_cast<uint64_t*>(base_ + header_->container_offset);
+  return container + 1 + (bucket_number & (container[0] - 1));
+}
+
+template <typename T, typename BucketPolicy>
+T* MappedDeque<T, BucketPolicy>::element(uint64_t offset) const {
+  return reinterpret_cast<T*>(base_ + *slot(offset >> kBucketShift)) +
+         (offset & kBucketMask);
+}
+
+template <typename T, typename BucketPolicy>
+T& MappedDeque<T, BucketPolicy>::operator[](size_t ind) {
+  return *element(header_->first_element_offset + ind);
+}
+
+template <typename T, typename BucketPolicy>
+const T& MappedDeque<T, BucketPolicy>::operator[](size_t ind) const {
+  return *element(header_->first_element_offset + ind);
+}
+
+template <typename T, typename BucketPolicy>
+T& MappedDeque<T, BucketPolicy>::at(size_t ind) {
+  if (ind >= size()) {
+    throw std::out_of_range("Index out of range");
+  }
+  return (*this)[ind];
+}
+
+template <typename T, typename BucketPolicy>
+const T& MappedDeque<T, BucketPolicy>::at(size_t ind) const {
+  if (ind >= size()) {
+    throw std::out_of_range("Index out of range");
+  }
+  return (*this)[ind];
+}
+
+template <typename T, typename BucketPolicy>
+uint64_t MappedDeque<T, BucketPolicy>::allocate(size_t bytes,
+                                                size_t alignment) {
+  uint64_t offset =
+      (header_->allocated_bytes + alignment - 1) & ~uint64_t{alignment - 1};
+  if (offset + bytes > header_->file_size) {
+    size_t page = ::sysconf(_SC_PAGESIZE);
+    size_t old_size = header_->file_size;
+    size_t new_size = std::max<size_t>(
+        2 * old_size, (offset + bytes + page - 1) & ~(page - 1));
+    if (::ftruncate(fd_, new_size) != 0) {
+      throw std::system_error(errno, std::generic_category(), "ftruncate");
+    }
+    ::munmap(base_, old_size);
+    base_ = nullptr;
+    map_file(new_size);
+    header_->file_size = new_size;
+  }
+  header_->allocated_bytes = offset + bytes;
+  return offset;
+}
+
+template <typename T, typename BucketPolicy>
+void MappedDeque<T, BucketPolicy>::reallocation() {
+  uint64_t old_offset = header_->container_offset;
+  size_t old_capacity =
+      old_offset == 0 ? 0 : reinterpret_cast<uint64_t*>(base_ + old_offset)[0];
+  size_t new_capacity = old_capacity == 0 ? kInitialCapacity : 2 * old_capacity;
+  uint64_t new_offset =
+      allocate((new_capacity + 1) * sizeof(uint64_t), alignof(uint64_t));
+  uint64_t* old_container = reinterpret_cast<uint64_t*>(base_ + old_offset);
+  uint64_t* new_container = reinterpret_cast<uint64_t*>(base_ + new_offset);
+  new_container[0] = new_capacity;
+  std::fill_n(new_container + 1, new_capacity, 0);
+  if (old_capacity != 0) {
+    uint64_t first_bucket = header_->first_element_offset >> kBucketShift;
+    uint64_t live_buckets =
+        empty() ? 0
+                : ((header_->end_element_offset - 1) >> kBucketShift) -
+                      first_bucket + 1;
+    for (uint64_t i = 0; i < live_buckets; ++i) {
+      new_container[1 + ((first_bucket + i) & (new_capacity - 1))] =
+          old_container[1 + ((first_bucket + i) & (old_capacity - 1))];
+    }
+    size_t free_slot = 0;
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (((i - first_bucket) & (old_capacity - 1)) < live_buckets ||
+          old_container[1 + i] == 0) {
+        continue;
+      }
+      while (new_container[1 + free_slot] != 0) {
+        ++free_slot;
+      }
+      new_container[1 + free_slot] = old_container[1 + i];
+    }
+  }
+  mark_dirty(new_offset, (new_capacity + 1) * sizeof(uint64_t));
+  std::atomic_signal_fence(std::memory_order_release);
+  header_->container_offset = new_offset;
+}
+
+template <typename T, typename BucketPolicy>
+T* MappedDeque<T, BucketPolicy>::install_bucket(uint64_t bucket_number) {
+  if (*slot(bucket_number) == 0) {
+    uint64_t offset = allocate(kBucketBytes, kBucketAlignment);
+    *slot(bucket_number) = offset;
+    mark_dirty(reinterpret_cast<char*>(slot(bucket_number)) - base_,
+               sizeof(uint64_t));
+  }
+  uint64_t offset = *slot(bucket_number);
+  if (offset != last_dirty_bucket_) {
+    mark_dirty(offset, kBucketBytes);
+    last_dirty_bucket_ = offset;
+  }
+  return reinterpret_cast<T*>(base_ + offset);
+}
+
+template <typename T, typename BucketPolicy>
+void MappedDeque<T, BucketPolicy>::push_back(const T& value) {
+  T copy = value;
+  uint64_t offset = header_->end_element_offset;
+  if (header_->container_offset == 0 ||
+      (offset >> kBucketShift) -
+              (header_->first_element_offset >> kBucketShift) >=
+          reinterpret_cast<uint64_t*>(base_ + header_->container_offset)[0]) {
+    reallocation();
+  }
+  T* bucket = install_bucket(offset >> kBucketShift);
+  std::memcpy(bucket + (offset & kBucketMask), &copy, sizeof(T));
+  std::atomic_signal_fence(std::memory_order_release);
+  header_->end_element_offset = offset + 1;
+}
+
+template <typename T, typename BucketPolicy>
+void MappedDeque<T, BucketPolicy>::push_front(const T& value) {
+  T copy = value;
+  uint64_t offset = header_->first_element_offset - 1;
+  if (header_->container_offset == 0 ||
+      ((header_->end_element_offset - 1) >> kBucketShift) -
+              (offset >> kBucketShift) >=
+          reinterpret_cast<uint64_t*>(base_ + header_->container_offset)[0]) {
+    reallocation();
+  }
+  T* bucket = install_bucket(offset >> kBucketShift);
+  std::memcpy(bucket + (offset & kBucketMask), &copy, sizeof(T));
+  std::atomic_signal_fence(std::memory_order_release);
+  header_->first_element_offset = offset;
+}
+
+template <typename T, typename BucketPolicy>
+void MappedDeque<T, BucketPolicy>::pop_back() {
+  --header_->end_element_offset;
+}
+
+template <typename T, typename BucketPolicy>
+void MappedDeque<T, BucketPolicy>::pop_front() {
+  ++header_->first_element_offset;
+}
+
+template <typename T, typename BucketPolicy>
+void MappedDeque<T, BucketPolicy>::mark_dirty(uint64_t offset, size_t bytes) {
+  size_t& dirty_bytes = dirty_[offset];
+  dirty_bytes = std::max(dirty_bytes, bytes);
+}
+
+template <typename T, typename BucketPolicy>
+void MappedDeque<T, BucketPolicy>::sync_range(uint64_t offset, size_t bytes) {
+  uint64_t page = ::sysconf(_SC_PAGESIZE);
+  uint64_t start = offset & ~(page - 1);
+  if (::msync(base_ + start, offset + bytes - start, MS_SYNC) != 0) {
+    throw std::system_error(errno, std::generic_category(), "msync");
+  }
+}
+
+template <typename T, typename BucketPolicy>
+void MappedDeque<T, BucketPolicy>::sync() {
+  uint64_t start = 0;
+  uint64_t end = 0;
+  for (const auto& [offset, bytes] : dirty_) {
+    if (offset > end) {
+      if (end != start) {
+        sync_range(start, end - start);
+      }
+      start = offset;
+    }
+    end = std::max<uint64_t>(end, offset + bytes);
+  }
+  if (end != start) {
+    sync_range(start, end - start);
+  }
+  dirty_.clear();
+  last_dirty_bucket_ = 0;
+  sync_range(0, sizeof(Header));
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <memory_resource>
+
+#include "deque.hpp"
+
+template <typename T, typename BucketPolicy = DefaultBucketPolicy<T>>
+using PmrDeque = Deque<T, std::pmr::polymorphic_allocator<T>, BucketPolicy>;
+
+template <typename T, typename BucketPolicy = DefaultBucketPolicy<T>>
+class BucketArenaResource : public std::pmr::memory_resource {
+ public:
+  explicit BucketArenaResource(
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+  BucketArenaResource(const BucketArenaResource& other) = delete;
+  BucketArenaResource& operator=(const BucketArenaResource& other) = delete;
+
+  void release();
+
+  static constexpr size_t kBlockBytes =
+      std::max(BucketPolicy::kBucketSize * sizeof(T), sizeof(void*));
+  static constexpr size_t kBlockAlignment =
+      std::max(alignof(T), alignof(void*));
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  static constexpr size_t kInitialBlocks = 4;
+
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const
+      noexcept override;
+  static bool is_block(size_t bytes, size_t alignment);
+
+  std::pmr::monotonic_buffer_resource arena_;
+  FreeBlock* free_blocks_ = nullptr;
+};
+
+template <typename T, typename BucketPolicy>
+BucketArenaResource<T, BucketPolicy>::BucketArenaResource(
+    std::pmr::memory_resource* upstream)
+    : arena_(kInitialBlocks * kBlockBytes, upstream) {}
+
+template <typename T, typename BucketPolicy>
+void BucketArenaResource<T, BucketPolicy>::release() {
+  arena_.release();
+  free_blocks_ = nullptr;
+}
+
+template <typename T, typename BucketPolicy>
+void* BucketArenaResource<T, BucketPolicy>::do_allocate(size_t bytes,
+                                                        size_t alignment) {
+  if (!is_block(bytes, alignment)) {
+    return arena_.allocate(bytes, alignment);
+  }
+  if (free_blocks_ == nullptr) {
+    return arena_.allocate(kBlockBytes, kBlockAlignment);
+  }
+  FreeBlock* block = free_blocks_;
+  free_blocks_ = block->next;
+  return block;
+}
+
+template <typename T, typename BucketPolicy>
+void BucketArenaResource<T, BucketPolicy>::do_deallocate(void* pointer,
+                                                         size_t bytes,
+                                                         size_t alignment) {
+  if (is_block(bytes, alignment)) {
+    free_blocks_ = ::new (pointer) FreeBlock{free_blocks_};
+  }
+}
+
+template <typename T, typename BucketPolicy>
+bool BucketArenaResource<T, BucketPolicy>::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+template <typename T, typename BucketPolicy>
+bool BucketArenaResource<T, BucketPolicy>::is_block(size_t bytes,
+                                                    size_t alignment) {
+  return bytes == kBlockBytes && alignment <= kBlockAlignment;
+}
@@ -0,0 +1,594 @@
+#pragma once
+#include <stdexcept>
+
+#include "deque.hpp"
+
+template <typename T, typename Allocator = std::allocator<T>,
+          typename BucketPolicy = DefaultBucketPolicy<T>>
+class RingDeque {
+ public:
+  explicit RingDeque(size_t capacity, const Allocator& alloc = Allocator());
+  RingDeque(const RingDeque& other);
+  RingDeque(RingDeque&& other);
+  RingDeque& operator=(const RingDeque& other) = delete;
+  RingDeque& operator=(RingDeque&& other) = delete;
+  ~RingDeque();
+
+  size_t size() const;
+  size_t capacity() const;
+  bool empty() const;
+  bool full() const;
+  T& operator[](size_t ind);
+  const T& operator[](size_t ind) const;
+  T& at(size_t ind);
+  const T& at(size_t ind) const;
+  T& front();
+  const T& front() const;
+  T& back();
+  const T& back() const;
+
+  void push_back(T&& value);
+  void push_back(const T& value);
+  void push_front(T&& value);
+  void push_front(const T& value);
+  void push_back_overwrite(T&& value);
+  void push_back_overwrite(const T& value);
+  void pop_back();
+  void pop_front();
+  template <typename... Arguments>
+  void emplace_back(Arguments&&... args);
+  template <typename... Arguments>
+  void emplace_front(Arguments&&... args);
+  template <typename... Arguments>
+  void emplace_back_overwrite(Arguments&&... args);
+
+  template <bool IsConst>
+  class Iterator;
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+  using reverse_iterator = std::reverse_iterator<Iterator<false>>;
+  using const_reverse_iterator = std::reverse_iterator<Iterator<true>>;
+
+  iterator begin();
+  const_iterator cbegin() const;
+  iterator end();
+  const_iterator cend() const;
+  reverse_iterator rbegin();
+  reverse_iterator rend();
+  const_reverse_iterator crbegin() const;
+  const_reverse_iterator crend() const;
+
+  using allocator_type = Allocator;
+  using allocator_traits = std::allocator_traits<allocator_type>;
+
+  using container_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<T*>;
+  using container_allocator_traits = std::allocator_traits<container_allocator>;
+
+  allocator_type get_allocator() const { return alloc_; }
+
+ private:
+  void allocate_storage();
+  void release_storage();
+  T* slot(size_t offset) const;
+
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+  size_t head_ = 0;
+  size_t container_capacity_ = 0;
+  size_t mask_ = 0;
+  T** container_ = nullptr;
+  static constexpr size_t kBucketSize = BucketPolicy::kBucketSize;
+  static constexpr size_t kBucketShift = std::countr_zero(kBucketSize);
+  static constexpr size_t kBucketMask = kBucketSize - 1;
+  static_assert(std::has_single_bit(kBucketSize),
+                "bucket size must be a power of two");
+  static constexpr bool kTriviallyDestructible =
+      !CustomizesConstruction<allocator_type, T> &&
+      std::is_trivially_destructible_v<T>;
+
+  allocator_type alloc_;
+  container_allocator container_alloc_;
+};
+
+template <typename T, typename Allocator, typename BucketPolicy>
+RingDeque<T, Allocator, BucketPolicy>::RingDeque(size_t capacity,
+                                                 const Allocator& alloc)
+    : capacity_(capacity), alloc_(alloc), container_alloc_(alloc) {
+  allocate_storage();
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+RingDeque<T, Allocator, BucketPolicy>::RingDeque(const RingDeque& other)
+    : capacity_(other.capacity_),
+      alloc_(allocator_traits::select_on_container_copy_construction(
+          other.alloc_)),
+      container_alloc_(alloc_) {
+  allocate_storage();
+  try {
+    for (size_t i = 0; i < other.size_; ++i) {
+      emplace_back(other[i]);
+    }
+  } catch (...) {
+    release_storage();
+    throw;
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+RingDeque<T, Allocator, BucketPolicy>::RingDeque(RingDeque&& other)
+    : capacity_(other.capacity_),
+      size_(other.size_),
+      head_(other.head_),
+      container_capacity_(other.container_capacity_),
+      mask_(other.mask_),
+      container_(other.container_),
+      alloc_(other.alloc_),
+      container_alloc_(other.container_alloc_) {
+  other.capacity_ = 0;
+  other.size_ = 0;
+  other.head_ = 0;
+  other.container_capacity_ = 0;
+  other.mask_ = 0;
+  other.container_ = nullptr;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+RingDeque<T, Allocator, BucketPolicy>::~RingDeque() {
+  release_storage();
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void RingDeque<T, Allocator, BucketPolicy>::allocate_storage() {
+  if (capacity_ == 0) {
+    return;
+  }
+  size_t buckets =
+      std::bit_ceil((capacity_ + 1 + kBucketMask) >> kBucketShift);
+  container_ = container_allocator_traits::allocate(container_alloc_, buckets);
+  size_t allocated = 0;
+  try {
+    for (; allocated < buckets; ++allocated) {
+      container_[allocated] = allocator_traits::allocate(alloc_, kBucketSize);
+    }
+  } catch (...) {
+    for (size_t i = 0; i < allocated; ++i) {
+      allocator_traits::deallocate(alloc_, container_[i], kBucketSize);
+    }
+    container_allocator_traits::deallocate(container_alloc_, container_,
+                                           buckets);
+    container_ = nullptr;
+    throw;
+  }
+  container_capacity_ = buckets;
+  mask_ = (buckets << kBucketShift) - 1;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void RingDeque<T, Allocator, BucketPolicy>::release_storage() {
+  if (container_ == nullptr) {
+    return;
+  }
+  if constexpr (!kTriviallyDestructible) {
+    for (size_t i = 0; i < size_; ++i) {
+      allocator_traits::destroy(alloc_, slot(head_ + i));
+    }
+  }
+  for (size_t i = 0; i < container_capacity_; ++i) {
+    allocator_traits::deallocate(alloc_, container_[i], kBucketSize);
+  }
+  container_allocator_traits::deallocate(container_alloc_, container_,
+                                         container_capacity_);
+  container_ = nullptr;
+  size_ = 0;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+T* RingDeque<T, Allocator, BucketPolicy>::slot(size_t offset) const {
+  offset &= mask_;
+  return container_[offset >> kBucketShift] + (offset & kBucketMask);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+size_t RingDeque<T, Allocator, BucketPolicy>::size() const {
+  return size_;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+size_t RingDeque<T, Allocator, BucketPolicy>::capacity() const {
+  return capacity_;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+bool RingDeque<T, Allocator, BucketPolicy>::empty() const {
+  return size_ == 0;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+bool RingDeque<T, Allocator, BucketPolicy>::full() const {
+  return size_ == capacity_;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+T& RingDeque<T, Allocator, BucketPolicy>::operator[](size_t ind) {
+  return *slot(head_ + ind);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+const T& RingDeque<T, Allocator, BucketPolicy>::operator[](size_t ind) const {
+  return *slot(head_ + ind);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+T& RingDeque<T, Allocator, BucketPolicy>::at(size_t ind) {
+  if (ind >= size_) {
+    throw std::out_of_range("Index out of range");
+  }
+  return *slot(head_ + ind);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+const T& RingDeque<T, Allocator, BucketPolicy>::at(size_t ind) const {
+  if (ind >= size_) {
+    throw std::out_of_range("Index out of range");
+  }
+  return *slot(head_ + ind);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+T& RingDeque<T, Allocator, BucketPolicy>::front() {
+  return *slot(head_);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+const T& RingDeque<T, Allocator, BucketPolicy>::front() const {
+  return *slot(head_);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+T& RingDeque<T, Allocator, BucketPolicy>::back() {
+  return *slot(head_ + size_ - 1);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+const T& RingDeque<T, Allocator, BucketPolicy>::back() const {
+  return *slot(head_ + size_ - 1);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void RingDeque<T, Allocator, BucketPolicy>::push_back(T&& value) {
+  emplace_back(std::move(value));
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void RingDeque<T, Allocator, BucketPolicy>::push_back(const T& value) {
+  emplace_back(value);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void RingDeque<T, Allocator, BucketPolicy>::push_front(T&& value) {
+  emplace_front(std::move(value));
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void RingDeque<T, Allocator, BucketPolicy>::push_front(const T& value) {
+  emplace_front(value);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void RingDeque<T, Allocator, BucketPolicy>::push_back_overwrite(T&& value) {
+  emplace_back_overwrite(std::move(value));
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void RingDeque<T, Allocator, BucketPolicy>::push_back_overwrite(
+    const T& value) {
+  emplace_back_overwrite(value);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void RingDeque<T, Allocator, BucketPolicy>::pop_back() {
+  if constexpr (!kTriviallyDestructible) {
+    allocator_traits::destroy(alloc_, slot(head_ + size_ - 1));
+  }
+  --size_;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void RingDeque<T, Allocator, BucketPolicy>::pop_front() {
+  if constexpr (!kTriviallyDestructible) {
+    allocator_traits::destroy(alloc_, slot(head_));
+  }
+  head_ = (head_ + 1) & mask_;
+  --size_;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename... Arguments>
+void RingDeque<T, Allocator, BucketPolicy>::emplace_back(Arguments&&... args) {
+  if (full()) {
+    throw std::length_error("RingDeque is full");
+  }
+  allocator_traits::construct(alloc_, slot(head_ + size_),
+                              std::forward<Arguments>(args)...);
+  ++size_;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename... Arguments>
+void RingDeque<T, Allocator, BucketPolicy>::emplace_front(
+    Arguments&&... args) {
+  if (full()) {
+    throw std::length_error("RingDeque is full");
+  }
+  size_t head = (head_ - 1) & mask_;
+  allocator_traits::construct(alloc_, slot(head),
+                              std::forward<Arguments>(args)...);
+  head_ = head;
+  ++size_;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename... Arguments>
+void RingDeque<T, Allocator, BucketPolicy>::emplace_back_overwrite(
+    Arguments&&... args) {
+  if (capacity_ == 0) {
+    return;
+  }
+  allocator_traits::construct(alloc_, slot(head_ + size_),
+                              std::forward<Arguments>(args)...);
+  ++size_;
+  if (size_ > capacity_) {
+    pop_front();
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+class RingDeque<T, Allocator, BucketPolicy>::Iterator {
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using cond_type = std::conditional_t<IsConst, const T, T>;
+  using value_type = T;
+  using pointer = cond_type*;
+  using reference = cond_type&;
+  using difference_type = std::ptrdiff_t;
+
+  Iterator() = default;
+  Iterator(T** ptr, size_t mask, size_t offset);
+  Iterator(const Iterator& other) = default;
+  Iterator& operator=(const Iterator& other) = default;
+
+  Iterator& operator++();
+  Iterator& operator--();
+  Iterator operator++(int);
+  Iterator operator--(int);
+  Iterator& operator+=(difference_type number);
+  Iterator& operator-=(difference_type number);
+  Iterator operator+(difference_type number) const;
+  Iterator operator-(difference_type number) const;
+  friend Iterator operator+(difference_type number, const Iterator& iter) {
+    return iter + number;
+  }
+
+  bool operator<(const Iterator& other) const;
+  bool operator==(const Iterator& other) const;
+  bool operator>(const Iterator& other) const;
+  bool operator!=(const Iterator& other) const;
+  bool operator<=(const Iterator& other) const;
+  bool operator>=(const Iterator& other) const;
+
+  difference_type operator-(const Iterator& other) const;
+  reference operator*() const;
+  pointer operator->() const;
+  reference operator[](difference_type number) const;
+
+ private:
+  T** ptr_ = nullptr;
+  size_t mask_ = 0;
+  size_t offset_ = 0;
+};
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::Iterator(
+    T** ptr, size_t mask, size_t offset)
+    : ptr_(ptr), mask_(mask), offset_(offset) {}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+typename RingDeque<T, Allocator, BucketPolicy>::template Iterator<IsConst>&
+RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator++() {
+  ++offset_;
+  return *this;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+typename RingDeque<T, Allocator, BucketPolicy>::template Iterator<IsConst>&
+RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator--() {
+  --offset_;
+  return *this;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+typename RingDeque<T, Allocator, BucketPolicy>::template Iterator<IsConst>
+RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator++(int) {
+  Iterator copy = *this;
+  ++offset_;
+  return copy;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+typename RingDeque<T, Allocator, BucketPolicy>::template Iterator<IsConst>
+RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator--(int) {
+  Iterator copy = *this;
+  --offset_;
+  return copy;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+typename RingDeque<T, Allocator, BucketPolicy>::template Iterator<IsConst>&
+RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator+=(
+    difference_type number) {
+  offset_ += number;
+  return *this;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+typename RingDeque<T, Allocator, BucketPolicy>::template Iterator<IsConst>&
+RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator-=(
+    difference_type number) {
+  offset_ -= number;
+  return *this;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+typename RingDeque<T, Allocator, BucketPolicy>::template Iterator<IsConst>
+RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator+(
+    difference_type number) const {
+  Iterator copy = *this;
+  copy += number;
+  return copy;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+typename RingDeque<T, Allocator, BucketPolicy>::template Iterator<IsConst>
+RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator-(
+    difference_type number) const {
+  Iterator copy = *this;
+  copy -= number;
+  return copy;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+bool RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator<(
+    const Iterator& other) const {
+  return offset_ < other.offset_;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+bool RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator==(
+    const Iterator& other) const {
+  return offset_ == other.offset_;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+bool RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator>(
+    const Iterator& other) const {
+  return other < *this;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+bool RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator!=(
+    const Iterator& other) const {
+  return !(*this == other);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+bool RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator<=(
+    const Iterator& other) const {
+  return !(other < *this);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+bool RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator>=(
+    const Iterator& other) const {
+  return !(*this < other);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+typename RingDeque<T, Allocator, BucketPolicy>::template Iterator<
+    IsConst>::difference_type
+RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator-(
+    const Iterator& other) const {
+  return static_cast<difference_type>(offset_ - other.offset_);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+typename RingDeque<T, Allocator, BucketPolicy>::template Iterator<
+    IsConst>::reference
+RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator*() const {
+  size_t offset = offset_ & mask_;
+  return ptr_[offset >> kBucketShift][offset & kBucketMask];
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+typename RingDeque<T, Allocator, BucketPolicy>::template Iterator<
+    IsConst>::pointer
+RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator->() const {
+  return &**this;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <bool IsConst>
+typename RingDeque<T, Allocator, BucketPolicy>::template Iterator<
+    IsConst>::reference
+RingDeque<T, Allocator, BucketPolicy>::Iterator<IsConst>::operator[](
+    difference_type number) const {
+  return *(*this + number);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename RingDeque<T, Allocator, BucketPolicy>::iterator
+RingDeque<T, Allocator, BucketPolicy>::begin() {
+  return iterator(container_, mask_, head_);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename RingDeque<T, Allocator, BucketPolicy>::const_iterator
+RingDeque<T, Allocator, BucketPolicy>::cbegin() const {
+  return const_iterator(container_, mask_, head_);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename RingDeque<T, Allocator, BucketPolicy>::iterator
+RingDeque<T, Allocator, BucketPolicy>::end() {
+  return iterator(container_, mask_, head_ + size_);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename RingDeque<T, Allocator, BucketPolicy>::const_iterator
+RingDeque<T, Allocator, BucketPolicy>::cend() const {
+  return const_iterator(container_, mask_, head_ + size_);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename RingDeque<T, Allocator, BucketPolicy>::reverse_iterator
+RingDeque<T, Allocator, BucketPolicy>::rbegin() {
+  return std::make_reverse_iterator(end());
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename RingDeque<T, Allocator, BucketPolicy>::reverse_iterator
+RingDeque<T, Allocator, BucketPolicy>::rend() {
+  return std::make_reverse_iterator(begin());
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename RingDeque<T, Allocator, BucketPolicy>::const_reverse_iterator
+RingDeque<T, Allocator, BucketPolicy>::crbegin() const {
+  return std::make_reverse_iterator(cend());
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename RingDeque<T, Allocator, BucketPolicy>::const_reverse_iterator
+RingDeque<T, Allocator, BucketPolicy>::crend() const {
+  return std::make_reverse_iterator(cbegin());
+}
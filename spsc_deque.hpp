@@ -0,0 +1,281 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "deque.hpp"
+
+template <typename T, typename Allocator = std::allocator<T>,
+          typename BucketPolicy = DefaultBucketPolicy<T>>
+class SpscDeque {
+ public:
+  SpscDeque() = default;
+  explicit SpscDeque(const Allocator& allocator);
+  SpscDeque(const SpscDeque& other) = delete;
+  SpscDeque& operator=(const SpscDeque& other) = delete;
+  ~SpscDeque();
+
+  template <typename... Arguments>
+  void emplace_back(Arguments&&... args);
+  void push_back(const T& value);
+  void push_back(T&& value);
+
+  T* front();
+  void pop_front();
+  bool try_pop_front(T& value);
+
+  size_t size() const;
+  bool empty() const;
+
+  using allocator_type = Allocator;
+  using allocator_traits = std::allocator_traits<allocator_type>;
+
+  allocator_type get_allocator() const { return alloc_; }
+
+ private:
+  struct Container {
+    T** buckets;
+    size_t capacity;
+  };
+
+  using bucket_map_allocator =
+      typename allocator_traits::template rebind_alloc<T*>;
+  using bucket_map_allocator_traits =
+      std::allocator_traits<bucket_map_allocator>;
+  using container_allocator =
+      typename allocator_traits::template rebind_alloc<Container>;
+  using container_allocator_traits = std::allocator_traits<container_allocator>;
+  using retired_allocator =
+      typename allocator_traits::template rebind_alloc<Container*>;
+
+  static constexpr size_t kBucketSize = BucketPolicy::kBucketSize;
+  static constexpr size_t kBucketShift = std::countr_zero(kBucketSize);
+  static constexpr size_t kBucketMask = kBucketSize - 1;
+  static constexpr size_t kInitialCapacity = 4;
+  static constexpr size_t kCacheLine = 64;
+  static constexpr size_t kNoBucket = SIZE_MAX;
+  static_assert(std::has_single_bit(kBucketSize),
+                "bucket size must be a power of two");
+
+  T* install_bucket(size_t bucket_number);
+  void reallocation(size_t head_bucket, size_t bucket_number);
+  T* consumer_bucket(size_t bucket_number);
+  void release_container(Container* container);
+  void reclaim_retired();
+
+  alignas(kCacheLine) std::atomic<size_t> head_{0};
+  size_t tail_cache_ = 0;
+  size_t consumer_bucket_number_ = kNoBucket;
+  T* consumer_bucket_ = nullptr;
+
+  alignas(kCacheLine) std::atomic<size_t> tail_{0};
+  size_t installed_buckets_ = 0;
+  T* producer_bucket_ = nullptr;
+
+  alignas(kCacheLine) std::atomic<Container*> container_{nullptr};
+  std::atomic<Container*> hazard_{nullptr};
+  std::atomic<T*> spare_bucket_{nullptr};
+  std::vector<Container*, retired_allocator> retired_;
+
+  allocator_type alloc_;
+  bucket_map_allocator bucket_map_alloc_{alloc_};
+  container_allocator container_alloc_{alloc_};
+};
+
+template <typename T, typename Allocator, typename BucketPolicy>
+SpscDeque<T, Allocator, BucketPolicy>::SpscDeque(const Allocator& allocator)
+    : retired_(retired_allocator(allocator)),
+      alloc_(allocator),
+      bucket_map_alloc_(allocator),
+      container_alloc_(allocator) {}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+SpscDeque<T, Allocator, BucketPolicy>::~SpscDeque() {
+  size_t head = head_.load(std::memory_order_relaxed);
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  Container* container = container_.load(std::memory_order_relaxed);
+  for (size_t i = head; i < tail; ++i) {
+    T* bucket = container->buckets[(i >> kBucketShift) &
+                                   (container->capacity - 1)];
+    allocator_traits::destroy(alloc_, bucket + (i & kBucketMask));
+  }
+  for (size_t i = head >> kBucketShift; i < installed_buckets_; ++i) {
+    allocator_traits::deallocate(
+        alloc_, container->buckets[i & (container->capacity - 1)],
+        kBucketSize);
+  }
+  if (T* spare = spare_bucket_.load(std::memory_order_relaxed)) {
+    allocator_traits::deallocate(alloc_, spare, kBucketSize);
+  }
+  for (Container* retired : retired_) {
+    release_container(retired);
+  }
+  if (container != nullptr) {
+    release_container(container);
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+template <typename... Arguments>
+void SpscDeque<T, Allocator, BucketPolicy>::emplace_back(
+    Arguments&&... args) {
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  if ((tail >> kBucketShift) == installed_buckets_) {
+    producer_bucket_ = install_bucket(installed_buckets_);
+    ++installed_buckets_;
+  }
+  allocator_traits::construct(alloc_, producer_bucket_ + (tail & kBucketMask),
+                              std::forward<Arguments>(args)...);
+  tail_.store(tail + 1, std::memory_order_release);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void SpscDeque<T, Allocator, BucketPolicy>::push_back(const T& value) {
+  emplace_back(value);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void SpscDeque<T, Allocator, BucketPolicy>::push_back(T&& value) {
+  emplace_back(std::move(value));
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+T* SpscDeque<T, Allocator, BucketPolicy>::front() {
+  size_t head = head_.load(std::memory_order_relaxed);
+  if (head == tail_cache_) {
+    tail_cache_ = tail_.load(std::memory_order_acquire);
+    if (head == tail_cache_) {
+      return nullptr;
+    }
+  }
+  return consumer_bucket(head >> kBucketShift) + (head & kBucketMask);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void SpscDeque<T, Allocator, BucketPolicy>::pop_front() {
+  size_t head = head_.load(std::memory_order_relaxed);
+  T* bucket = consumer_bucket(head >> kBucketShift);
+  allocator_traits::destroy(alloc_, bucket + (head & kBucketMask));
+  if ((head & kBucketMask) == kBucketMask) {
+    consumer_bucket_number_ = kNoBucket;
+    T* previous = spare_bucket_.exchange(bucket, std::memory_order_acq_rel);
+    if (previous != nullptr) {
+      allocator_traits::deallocate(alloc_, previous, kBucketSize);
+    }
+  }
+  head_.store(head + 1, std::memory_order_release);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+bool SpscDeque<T, Allocator, BucketPolicy>::try_pop_front(T& value) {
+  T* element = front();
+  if (element == nullptr) {
+    return false;
+  }
+  value = std::move(*element);
+  pop_front();
+  return true;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+size_t SpscDeque<T, Allocator, BucketPolicy>::size() const {
+  size_t head = head_.load(std::memory_order_acquire);
+  return tail_.load(std::memory_order_acquire) - head;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+bool SpscDeque<T, Allocator, BucketPolicy>::empty() const {
+  return size() == 0;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+T* SpscDeque<T, Allocator, BucketPolicy>::install_bucket(
+    size_t bucket_number) {
+  Container* container = container_.load(std::memory_order_relaxed);
+  size_t head_bucket =
+      head_.load(std::memory_order_acquire) >> kBucketShift;
+  if (container == nullptr ||
+      bucket_number - head_bucket >= container->capacity) {
+    reallocation(head_bucket, bucket_number);
+    container = container_.load(std::memory_order_relaxed);
+  }
+  T* bucket = spare_bucket_.exchange(nullptr, std::memory_order_acquire);
+  if (bucket == nullptr) {
+    bucket = allocator_traits::allocate(alloc_, kBucketSize);
+  }
+  container->buckets[bucket_number & (container->capacity - 1)] = bucket;
+  return bucket;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void SpscDeque<T, Allocator, BucketPolicy>::reallocation(
+    size_t head_bucket, size_t bucket_number) {
+  Container* old_container = container_.load(std::memory_order_relaxed);
+  size_t new_capacity =
+      old_container == nullptr ? kInitialCapacity : 2 * old_container->capacity;
+  new_capacity = std::max(new_capacity,
+                          std::bit_ceil(bucket_number - head_bucket + 1));
+  retired_.reserve(retired_.size() + 1);
+  Container* new_container =
+      container_allocator_traits::allocate(container_alloc_, 1);
+  try {
+    new_container->buckets =
+        bucket_map_allocator_traits::allocate(bucket_map_alloc_, new_capacity);
+  } catch (...) {
+    container_allocator_traits::deallocate(container_alloc_, new_container, 1);
+    throw;
+  }
+  new_container->capacity = new_capacity;
+  for (size_t i = 0; i < new_capacity; ++i) {
+    bucket_map_allocator_traits::construct(
+        bucket_map_alloc_, new_container->buckets + i, nullptr);
+  }
+  for (size_t i = head_bucket; i < bucket_number; ++i) {
+    new_container->buckets[i & (new_capacity - 1)] =
+        old_container->buckets[i & (old_container->capacity - 1)];
+  }
+  container_.store(new_container, std::memory_order_seq_cst);
+  if (old_container != nullptr) {
+    retired_.push_back(old_container);
+  }
+  reclaim_retired();
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+T* SpscDeque<T, Allocator, BucketPolicy>::consumer_bucket(
+    size_t bucket_number) {
+  if (consumer_bucket_number_ != bucket_number) {
+    Container* container = container_.load(std::memory_order_seq_cst);
+    hazard_.store(container, std::memory_order_seq_cst);
+    while (container != container_.load(std::memory_order_seq_cst)) {
+      container = container_.load(std::memory_order_seq_cst);
+      hazard_.store(container, std::memory_order_seq_cst);
+    }
+    consumer_bucket_ =
+        container->buckets[bucket_number & (container->capacity - 1)];
+    hazard_.store(nullptr, std::memory_order_release);
+    consumer_bucket_number_ = bucket_number;
+  }
+  return consumer_bucket_;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void SpscDeque<T, Allocator, BucketPolicy>::release_container(
+    Container* container) {
+  bucket_map_allocator_traits::deallocate(bucket_map_alloc_,
+                                          container->buckets,
+                                          container->capacity);
+  container_allocator_traits::deallocate(container_alloc_, container, 1);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void SpscDeque<T, Allocator, BucketPolicy>::reclaim_retired() {
+  Container* protected_container = hazard_.load(std::memory_order_seq_cst);
+  auto still_protected = std::partition(
+      retired_.begin(), retired_.end(),
+      [&](Container* retired) { return retired == protected_container; });
+  for (auto it = still_protected; it != retired_.end(); ++it) {
+    release_container(*it);
+  }
+  retired_.erase(still_protected, retired_.end());
+}
@@ -0,0 +1,138 @@
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "deque.hpp"
+
+struct AllocationCounts {
+  static inline size_t allocations = 0;
+  static inline size_t live = 0;
+};
+
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+
+  CountingAllocator() = default;
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>&) {}
+
+  T* allocate(size_t count) {
+    ++AllocationCounts::allocations;
+    ++AllocationCounts::live;
+    return std::allocator<T>().allocate(count);
+  }
+  void deallocate(T* pointer, size_t count) {
+    --AllocationCounts::live;
+    std::allocator<T>().deallocate(pointer, count);
+  }
+
+  template <typename U>
+  bool operator==(const CountingAllocator<U>&) const {
+    return true;
+  }
+};
+
+using CountingDeque = Deque<int, CountingAllocator<int>, FixedBucketPolicy<4>>;
+
+size_t used_buckets(const CountingDeque& deque) {
+  size_t buckets = 0;
+  deque.for_each_segment([&](std::span<const int>) { ++buckets; });
+  return buckets;
+}
+
+int main() {
+  {
+    CountingDeque deque;
+    deque.reserve_back(100);
+    size_t allocations = AllocationCounts::allocations;
+    for (int i = 0; i < 100; ++i) {
+      deque.push_back(i);
+    }
+    assert(AllocationCounts::allocations == allocations);
+    deque.reserve_back(37);
+    allocations = AllocationCounts::allocations;
+    std::vector<int> values(37, 7);
+    deque.append_range(values);
+    assert(AllocationCounts::allocations == allocations);
+    assert(deque.size() == 137 && deque[99] == 99 && deque[136] == 7);
+  }
+  assert(AllocationCounts::live == 0);
+
+  {
+    CountingDeque deque;
+    deque.reserve_front(100);
+    size_t allocations = AllocationCounts::allocations;
+    std::vector<int> values(100);
+    for (int i = 0; i < 100; ++i) {
+      values[i] = i;
+    }
+    deque.prepend_range(values);
+    assert(AllocationCounts::allocations == allocations);
+    assert(deque.size() == 100 && deque[0] == 0 && deque[99] == 99);
+
+    deque.reserve_front(50);
+    allocations = AllocationCounts::allocations;
+    for (int i = 1; i <= 50; ++i) {
+      deque.push_front(-i);
+    }
+    assert(AllocationCounts::allocations == allocations);
+    assert(deque.size() == 150 && deque[0] == -50 && deque[50] == 0);
+  }
+  assert(AllocationCounts::live == 0);
+
+  {
+    CountingDeque deque;
+    deque.reserve_front(5);
+    size_t allocations = AllocationCounts::allocations;
+    deque.push_front(1);
+    deque.push_front(0);
+    deque.push_back(2);
+    assert(AllocationCounts::allocations == allocations);
+    assert(deque[0] == 0 && deque[1] == 1 && deque[2] == 2);
+  }
+  assert(AllocationCounts::live == 0);
+
+  {
+    CountingDeque deque;
+    size_t allocations = 0;
+    int next = 0;
+    int expected = 0;
+    for (int round = 0; round < 2000; ++round) {
+      if (round == 100) {
+        allocations = AllocationCounts::allocations;
+      }
+      for (int i = 0; i < 1 + round % 7; ++i) {
+        deque.push_back(next++);
+      }
+      while (deque.size() > static_cast<size_t>(round % 3)) {
+        assert(deque[0] == expected++);
+        deque.pop_front();
+      }
+    }
+    assert(AllocationCounts::allocations == allocations);
+  }
+  assert(AllocationCounts::live == 0);
+
+  {
+    CountingDeque deque;
+    for (int i = 0; i < 200; ++i) {
+      deque.push_back(i);
+      deque.push_front(-i);
+    }
+    deque.pop_front(190);
+    deque.pop_back(199);
+    deque.shrink_to_fit();
+    assert(deque.size() == 11 && deque[0] == -9 && deque[10] == 0);
+    assert(AllocationCounts::live == used_buckets(deque) + 1);
+
+    deque.pop_back(deque.size());
+    deque.shrink_to_fit();
+    assert(AllocationCounts::live == 0);
+    deque.push_back(3);
+    assert(deque.size() == 1 && deque[0] == 3);
+  }
+  assert(AllocationCounts::live == 0);
+}
@@ -0,0 +1,160 @@
+#include <cassert>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include "deque.hpp"
+
+struct Blocks {
+  static inline std::map<const void*, int> owner;
+  static inline size_t allocations = 0;
+
+  static size_t live(int id) {
+    size_t count = 0;
+    for (const auto& [pointer, allocator] : owner) {
+      count += allocator == id ? 1 : 0;
+    }
+    return count;
+  }
+};
+
+template <typename T, bool PropagateCopy, bool PropagateMove>
+struct TaggedAllocator {
+  using value_type = T;
+  using propagate_on_container_copy_assignment =
+      std::bool_constant<PropagateCopy>;
+  using propagate_on_container_move_assignment =
+      std::bool_constant<PropagateMove>;
+  template <typename U>
+  struct rebind {
+    using other = TaggedAllocator<U, PropagateCopy, PropagateMove>;
+  };
+
+  explicit TaggedAllocator(int id) : id(id) {}
+  template <typename U>
+  TaggedAllocator(const TaggedAllocator<U, PropagateCopy, PropagateMove>& other)
+      : id(other.id) {}
+
+  T* allocate(size_t count) {
+    T* pointer = std::allocator<T>().allocate(count);
+    Blocks::owner[pointer] = id;
+    ++Blocks::allocations;
+    return pointer;
+  }
+  void deallocate(T* pointer, size_t count) {
+    auto block = Blocks::owner.find(pointer);
+    assert(block != Blocks::owner.end() && block->second == id);
+    Blocks::owner.erase(block);
+    std::allocator<T>().deallocate(pointer, count);
+  }
+
+  template <typename U>
+  bool operator==(
+      const TaggedAllocator<U, PropagateCopy, PropagateMove>& other) const {
+    return id == other.id;
+  }
+
+  int id;
+};
+
+template <bool PropagateCopy, bool PropagateMove>
+using TaggedDeque =
+    Deque<std::string,
+          TaggedAllocator<std::string, PropagateCopy, PropagateMove>,
+          FixedBucketPolicy<4>>;
+
+template <typename Container>
+Container make_deque(int id, int first, int count) {
+  Container deque{typename Container::allocator_type(id)};
+  for (int i = first; i < first + count; ++i) {
+    deque.push_back("value " + std::to_string(i));
+  }
+  return deque;
+}
+
+template <typename Container>
+bool holds(Container& deque, int first, int count) {
+  if (deque.size() != static_cast<size_t>(count)) {
+    return false;
+  }
+  for (int i = 0; i < count; ++i) {
+    if (deque[i] != "value " + std::to_string(first + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <bool PropagateCopy>
+void check_copy_assignment() {
+  using Container = TaggedDeque<PropagateCopy, false>;
+  for (int source_id : {1, 2}) {
+    Container target = make_deque<Container>(1, 100, 30);
+    Container source = make_deque<Container>(source_id, 0, 20);
+    bool adopts = PropagateCopy && source_id != 1;
+    size_t allocations = Blocks::allocations;
+    target = source;
+    assert(holds(target, 0, 20) && holds(source, 0, 20));
+    assert(target.get_allocator().id == (PropagateCopy ? source_id : 1));
+    if (adopts) {
+      assert(Blocks::live(1) == 0);
+    } else {
+      assert(Blocks::allocations == allocations);
+    }
+
+    Container longer = make_deque<Container>(source_id, 50, 45);
+    target = longer;
+    assert(holds(target, 50, 45));
+    target.push_front("value 49");
+    assert(holds(target, 49, 46));
+  }
+  assert(Blocks::owner.empty());
+}
+
+template <bool PropagateMove>
+void check_move_assignment() {
+  using Container = TaggedDeque<false, PropagateMove>;
+  for (int source_id : {1, 2}) {
+    Container target = make_deque<Container>(1, 100, 30);
+    Container source = make_deque<Container>(source_id, 0, 20);
+    bool steals = PropagateMove || source_id == 1;
+    size_t allocations = Blocks::allocations;
+    const std::string* source_front = &source[0];
+    target = std::move(source);
+    assert(holds(target, 0, 20) && source.empty());
+    assert(Blocks::allocations == allocations);
+    if (steals) {
+      assert(target.get_allocator().id == source_id);
+      assert(&target[0] == source_front);
+    } else {
+      assert(target.get_allocator().id == 1);
+      assert(source.get_allocator().id == 2 && &target[0] != source_front);
+    }
+    source.push_back("value 7");
+    assert(holds(source, 7, 1));
+
+    Container longer = make_deque<Container>(source_id, 50, 45);
+    target = std::move(longer);
+    assert(holds(target, 50, 45) && longer.empty());
+    target.push_front("value 49");
+    assert(holds(target, 49, 46));
+  }
+  assert(Blocks::owner.empty());
+}
+
+int main() {
+  check_copy_assignment<false>();
+  check_copy_assignment<true>();
+  check_move_assignment<false>();
+  check_move_assignment<true>();
+
+  using Container = TaggedDeque<false, false>;
+  Container target = make_deque<Container>(1, 0, 10);
+  Container& alias = target;
+  target = alias;
+  assert(holds(target, 0, 10));
+  target = std::move(alias);
+  assert(holds(target, 0, 10));
+}
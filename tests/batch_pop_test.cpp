@@ -0,0 +1,74 @@
+#include <cassert>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "deque.hpp"
+
+struct Counted {
+  explicit Counted(int value) : value(value) { ++alive; }
+  Counted(const Counted& other) : value(other.value) { ++alive; }
+  Counted& operator=(const Counted& other) = default;
+  ~Counted() { --alive; }
+
+  static inline int alive = 0;
+  int value;
+};
+
+using CountedDeque =
+    Deque<Counted, std::allocator<Counted>, FixedBucketPolicy<4>>;
+using StringDeque =
+    Deque<std::string, std::allocator<std::string>, FixedBucketPolicy<4>>;
+
+int main() {
+  {
+    CountedDeque deque;
+    for (int i = 0; i < 50; ++i) {
+      deque.push_back(Counted(i));
+    }
+    deque.push_front(Counted(-1));
+    deque.pop_front(13);
+    assert(deque.size() == 38 && Counted::alive == 38);
+    assert(deque[0].value == 12 && deque[37].value == 49);
+    deque.pop_back(17);
+    assert(deque.size() == 21 && Counted::alive == 21);
+    assert(deque[0].value == 12 && deque[20].value == 32);
+    deque.pop_front(0);
+    deque.pop_back(0);
+    assert(deque.size() == 21 && Counted::alive == 21);
+    deque.pop_back(deque.size());
+    assert(deque.empty() && Counted::alive == 0);
+    assert(deque.begin() == deque.end());
+
+    for (int i = 0; i < 10; ++i) {
+      deque.push_back(Counted(i));
+    }
+    deque.pop_front(deque.size());
+    assert(deque.empty() && Counted::alive == 0);
+    deque.push_back(Counted(7));
+    deque.push_front(Counted(6));
+    assert(deque.size() == 2 && deque[0].value == 6 && deque[1].value == 7);
+  }
+  assert(Counted::alive == 0);
+
+  StringDeque deque;
+  for (int i = 0; i < 40; ++i) {
+    deque.push_back(std::to_string(i));
+  }
+  std::vector<std::string> drained;
+  deque.drain_front(11, std::back_inserter(drained));
+  assert(drained.size() == 11 && deque.size() == 29);
+  for (int i = 0; i < 11; ++i) {
+    assert(drained[i] == std::to_string(i));
+  }
+  assert(deque[0] == "11");
+  deque.drain_front(100, std::back_inserter(drained));
+  assert(drained.size() == 40 && deque.empty());
+  for (int i = 0; i < 40; ++i) {
+    assert(drained[i] == std::to_string(i));
+  }
+  deque.drain_front(5, std::back_inserter(drained));
+  assert(drained.size() == 40);
+  deque.push_back("again");
+  assert(deque.size() == 1 && deque[0] == "again");
+}
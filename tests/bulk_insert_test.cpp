@@ -0,0 +1,127 @@
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "deque.hpp"
+
+using StringDeque =
+    Deque<std::string, std::allocator<std::string>, FixedBucketPolicy<4>>;
+
+struct Throwing {
+  explicit Throwing(int value) : value(value) { ++alive; }
+  Throwing(const Throwing& other) : value(other.value) {
+    if (value == throw_on) {
+      throw std::runtime_error("copy");
+    }
+    ++alive;
+  }
+  Throwing& operator=(const Throwing& other) = default;
+  ~Throwing() { --alive; }
+
+  static inline int alive = 0;
+  static inline int throw_on = -1;
+  int value;
+};
+
+bool same(StringDeque& deque, const std::vector<std::string>& expected) {
+  if (deque.size() != expected.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < expected.size(); ++i) {
+    if (deque[i] != expected[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<std::string> make_range(const std::string& prefix, int count) {
+  std::vector<std::string> range;
+  for (int i = 0; i < count; ++i) {
+    range.push_back(prefix + std::to_string(i));
+  }
+  return range;
+}
+
+int main() {
+  for (int front = 0; front < 4; ++front) {
+    for (int count : {1, 3, 4, 5, 9, 17}) {
+      StringDeque deque;
+      std::vector<std::string> expected;
+      for (int i = 0; i < 10; ++i) {
+        deque.push_back("x" + std::to_string(i));
+        expected.push_back("x" + std::to_string(i));
+      }
+      for (int i = 0; i < front; ++i) {
+        deque.push_front("f" + std::to_string(i));
+        expected.insert(expected.begin(), "f" + std::to_string(i));
+      }
+
+      std::vector<std::string> range = make_range("a", count);
+      deque.append_range(range);
+      expected.insert(expected.end(), range.begin(), range.end());
+      assert(same(deque, expected));
+
+      range = make_range("p", count);
+      deque.prepend_range(range);
+      expected.insert(expected.begin(), range.begin(), range.end());
+      assert(same(deque, expected));
+
+      for (size_t index : {size_t{0}, size_t{1}, expected.size() / 2,
+                           expected.size() - 1, expected.size()}) {
+        range = make_range("m" + std::to_string(index) + "_", count);
+        auto inserted = deque.insert(deque.begin() + index, range.begin(),
+                                     range.end());
+        assert(inserted - deque.begin() == static_cast<long>(index));
+        expected.insert(expected.begin() + index, range.begin(), range.end());
+        assert(same(deque, expected));
+
+        deque.insert(deque.begin() + index, count, "n");
+        expected.insert(expected.begin() + index, count, "n");
+        assert(same(deque, expected));
+      }
+    }
+  }
+
+  StringDeque empty;
+  empty.prepend_range(make_range("e", 6));
+  empty.append_range(std::vector<std::string>{});
+  empty.prepend_range(std::vector<std::string>{});
+  assert(same(empty, make_range("e", 6)));
+
+  Deque<Throwing, std::allocator<Throwing>, FixedBucketPolicy<4>> deque;
+  for (int i = 0; i < 6; ++i) {
+    deque.emplace_back(i);
+  }
+  std::vector<Throwing> source;
+  for (int i = 10; i < 23; ++i) {
+    source.emplace_back(i);
+  }
+  for (int throw_on : {10, 13, 20}) {
+    Throwing::throw_on = throw_on;
+    bool thrown = false;
+    try {
+      deque.append_range(source);
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    assert(thrown && deque.size() == 6 && deque[5].value == 5);
+    assert(Throwing::alive == 6 + 13);
+    deque.emplace_back(6);
+    assert(deque.size() == 7 && deque[6].value == 6);
+    deque.pop_back();
+  }
+  Throwing::throw_on = 15;
+  decltype(deque) fresh;
+  bool thrown = false;
+  try {
+    fresh.append_range(source);
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  assert(thrown && fresh.empty() && Throwing::alive == 6 + 13);
+  Throwing::throw_on = -1;
+  fresh.append_range(source);
+  assert(fresh.size() == 13 && fresh[12].value == 22);
+}
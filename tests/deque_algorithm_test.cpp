@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+#include "deque_algorithm.hpp"
+
+using SmallBucketDeque = Deque<int, std::allocator<int>, FixedBucketPolicy<4>>;
+
+void check(SmallBucketDeque& deque) {
+  const SmallBucketDeque& view = deque;
+  std::vector<int> expected(view.cbegin(), view.cend());
+
+  std::vector<int> copied;
+  segmented_copy(view, std::back_inserter(copied));
+  assert(copied == expected);
+  std::vector<int> buffer(expected.size() + 1, -1);
+  assert(segmented_copy(view, buffer.begin()) ==
+         buffer.begin() + expected.size());
+  assert(std::equal(expected.begin(), expected.end(), buffer.begin()));
+
+  for (int value : {0, 3, 7, 14, 99}) {
+    assert(segmented_find(view, value) ==
+           std::find(view.cbegin(), view.cend(), value));
+  }
+  for (int value : expected) {
+    auto found = segmented_find(view, value);
+    assert(found == std::find(view.cbegin(), view.cend(), value));
+    assert(*found == value);
+  }
+
+  assert(segmented_accumulate(view, 0L) ==
+         std::accumulate(expected.begin(), expected.end(), 0L));
+  auto fold = [](unsigned long hash, int value) { return hash * 31 + value; };
+  assert(segmented_accumulate(view, 7UL, fold) ==
+         std::accumulate(expected.begin(), expected.end(), 7UL, fold));
+
+  auto square = [](int value) { return value * value; };
+  std::vector<int> transformed;
+  segmented_transform(view, std::back_inserter(transformed), square);
+  std::vector<int> squares;
+  std::transform(expected.begin(), expected.end(),
+                 std::back_inserter(squares), square);
+  assert(transformed == squares);
+
+  segmented_transform(deque, [](int value) { return value + 1; });
+  for (size_t i = 0; i < expected.size(); ++i) {
+    assert(deque[i] == expected[i] + 1);
+  }
+
+  segmented_fill(deque, 42);
+  assert(std::count(deque.cbegin(), deque.cend(), 42) ==
+         static_cast<long>(expected.size()));
+}
+
+int main() {
+  SmallBucketDeque empty;
+  check(empty);
+
+  SmallBucketDeque single;
+  single.push_back(7);
+  check(single);
+
+  SmallBucketDeque deque;
+  for (int i = 0; i < 13; ++i) {
+    deque.push_back(i % 9);
+  }
+  deque.push_front(3);
+  size_t segments = deque.segment_count();
+  assert(segments > 2 && deque.segment(0).size() < 4 &&
+         deque.segment(segments - 1).size() < 4);
+  check(deque);
+  deque.pop_front();
+  deque.pop_back();
+  check(deque);
+}
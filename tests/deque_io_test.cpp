@@ -0,0 +1,88 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+#include "deque_io.hpp"
+
+using IoDeque = Deque<uint64_t, std::allocator<uint64_t>, FixedBucketPolicy<4>>;
+
+int open_file(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  assert(fd >= 0);
+  return fd;
+}
+
+bool load_fails(IoDeque& deque, int fd) {
+  ::lseek(fd, 0, SEEK_SET);
+  try {
+    load_deque(deque, fd);
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+  return false;
+}
+
+int main() {
+  std::string path = (std::filesystem::temp_directory_path() /
+                      ("deque_io_test." + std::to_string(::getpid())))
+                         .string();
+
+  IoDeque saved;
+  for (uint64_t i = 0; i < 1000; ++i) {
+    saved.push_back(i);
+    saved.push_front(100000 + i);
+  }
+  int fd = open_file(path);
+  save_deque(saved, fd);
+  IoDeque loaded;
+  loaded.push_back(42);
+  ::lseek(fd, 0, SEEK_SET);
+  load_deque(loaded, fd);
+  assert(loaded.size() == saved.size());
+  for (size_t i = 0; i < saved.size(); ++i) {
+    assert(loaded[i] == saved[i]);
+  }
+
+  assert(::ftruncate(fd, sizeof(DequeFileHeader) + 10 * sizeof(uint64_t)) ==
+         0);
+  assert(load_fails(loaded, fd));
+  assert(::ftruncate(fd, sizeof(DequeFileHeader) / 2) == 0);
+  assert(load_fails(loaded, fd));
+  assert(loaded.size() == saved.size());
+  ::close(fd);
+
+  IoDeque queue;
+  for (uint64_t i = 0; i < 100; ++i) {
+    queue.push_back(i);
+  }
+  fd = open_file(path);
+  assert(spill_front(queue, fd, 30) == 30);
+  assert(spill_front(queue, fd, 7) == 7);
+  assert(queue.size() == 63 && queue[0] == 37);
+  for (uint64_t i = 100; i < 150; ++i) {
+    queue.push_back(i);
+  }
+  ::lseek(fd, 0, SEEK_SET);
+  restore_front(queue, fd, 37);
+  assert(queue.size() == 150);
+  for (uint64_t i = 0; i < 150; ++i) {
+    assert(queue[i] == i);
+  }
+
+  IoDeque drained;
+  drained.push_back(1);
+  drained.push_back(2);
+  ::close(fd);
+  fd = open_file(path);
+  assert(spill_front(drained, fd, 5) == 2 && drained.empty());
+  ::lseek(fd, 0, SEEK_SET);
+  restore_front(drained, fd, 2);
+  assert(drained.size() == 2 && drained[0] == 1 && drained[1] == 2);
+  ::close(fd);
+  std::filesystem::remove(path);
+}
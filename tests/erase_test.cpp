@@ -0,0 +1,22 @@
+#include <cassert>
+#include <string>
+
+#include "deque.hpp"
+
+int main() {
+  Deque<std::string> deque;
+  for (int i = 0; i < 8; ++i) {
+    deque.push_back("s" + std::to_string(i));
+  }
+  deque.erase(deque.begin() + 2, deque.begin() + 2);
+  deque.erase(deque.begin() + 6, deque.begin() + 6);
+  assert(deque.size() == 8);
+  for (int i = 0; i < 8; ++i) {
+    assert(deque[i] == "s" + std::to_string(i));
+  }
+  deque.erase(deque.begin() + 1, deque.begin() + 3);
+  deque.erase(deque.begin() + 4, deque.begin() + 6);
+  assert(deque.size() == 4);
+  assert(deque[0] == "s0" && deque[1] == "s3" && deque[2] == "s4" &&
+         deque[3] == "s5");
+}
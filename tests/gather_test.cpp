@@ -0,0 +1,59 @@
+#include <cassert>
+#include <iterator>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "deque.hpp"
+
+using SmallBucketDeque = Deque<long, std::allocator<long>, FixedBucketPolicy<8>>;
+
+int main() {
+  SmallBucketDeque deque;
+  for (long i = 0; i < 1000; ++i) {
+    deque.push_back(i);
+  }
+  for (long i = 1; i <= 13; ++i) {
+    deque.push_front(-i);
+  }
+
+  std::vector<size_t> indices{5, 3, 3, 0, deque.size() - 1, 0, 5};
+  std::vector<long> gathered;
+  deque.gather(indices, std::back_inserter(gathered));
+  assert(gathered.size() == indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    assert(gathered[i] == deque[indices[i]]);
+  }
+
+  std::mt19937_64 random(24);
+  indices.clear();
+  for (int i = 0; i < 5000; ++i) {
+    size_t index = random() % deque.size();
+    indices.push_back(index);
+    if (i % 7 == 0) {
+      indices.push_back(index);
+    }
+  }
+  gathered.assign(indices.size(), 0);
+  auto out = deque.gather(indices, gathered.begin());
+  assert(out == gathered.end());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    assert(gathered[i] == static_cast<long>(indices[i]) - 13);
+  }
+
+  std::vector<size_t> none;
+  assert(deque.gather(none, gathered.begin()) == gathered.begin());
+
+  long expected = -13;
+  for (long element : deque) {
+    assert(element == expected++);
+  }
+  assert(expected == 1000);
+  long total = 0;
+  deque.for_each_segment([&](std::span<long> segment) {
+    for (long element : segment) {
+      total += element;
+    }
+  });
+  assert(total == 999 * 1000 / 2 - 13 * 14 / 2);
+}
@@ -0,0 +1,164 @@
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "deque.hpp"
+
+using HandleDeque = Deque<std::string, std::allocator<std::string>,
+                          StableHandlePolicy<FixedBucketPolicy<4>>>;
+
+void check_random_operations(uint64_t seed) {
+  Deque<long, std::allocator<long>, StableHandlePolicy<FixedBucketPolicy<4>>>
+      deque;
+  std::mt19937_64 random(seed);
+  std::vector<std::pair<DequeHandle, long>> handles;
+  long next = 0;
+  for (int step = 0; step < 100000; ++step) {
+    switch (random() % 9) {
+      case 0:
+        deque.push_back(next++);
+        break;
+      case 1:
+        deque.push_front(next++);
+        break;
+      case 2:
+        if (!deque.empty()) {
+          deque.pop_back();
+        }
+        break;
+      case 3:
+        if (!deque.empty()) {
+          deque.pop_front();
+        }
+        break;
+      case 4:
+        if (!deque.empty()) {
+          size_t index = random() % deque.size();
+          handles.emplace_back(deque.handle(index), deque[index]);
+          if (handles.size() > 64) {
+            handles.erase(handles.begin());
+          }
+        }
+        break;
+      case 5:
+        deque.pop_front(random() % (deque.size() / 3 + 1));
+        break;
+      case 6:
+        deque.pop_back(random() % (deque.size() / 3 + 1));
+        break;
+      case 7: {
+        std::vector<long> range;
+        for (size_t count = random() % 9; count != 0; --count) {
+          range.push_back(next++);
+        }
+        if (random() % 2 == 0) {
+          deque.append_range(range);
+        } else {
+          deque.prepend_range(range);
+        }
+        break;
+      }
+      case 8:
+        if (!deque.empty() && random() % 8 == 0) {
+          auto position = deque.begin() + random() % deque.size();
+          if (random() % 2 == 0) {
+            deque.erase(position);
+          } else {
+            deque.insert(position, next++);
+          }
+        }
+        break;
+    }
+    for (auto [handle, value] : handles) {
+      const long* element = deque.resolve(handle);
+      assert(element == nullptr || *element == value);
+    }
+  }
+}
+
+int main() {
+  HandleDeque deque;
+  HandleDeque other;
+  for (int i = 0; i < 100; ++i) {
+    deque.push_back(std::to_string(i));
+    other.push_back(std::to_string(100 + i));
+  }
+  DequeHandle handle = deque.handle(3);
+  for (int i = 0; i < 50; ++i) {
+    deque.pop_front();
+    deque.push_back("x");
+  }
+  assert(deque.resolve(handle) == nullptr);
+  handle = deque.handle(3);
+  assert(*deque.resolve(handle) == "53");
+
+  deque = other;
+  assert(deque.resolve(handle) == nullptr);
+  handle = deque.handle(3);
+  other.push_back("extra");
+  deque = other;
+  assert(deque.resolve(handle) == nullptr);
+  handle = deque.handle(3);
+  deque = HandleDeque(other);
+  assert(deque.resolve(handle) == nullptr);
+  assert(*deque.resolve(deque.handle(3)) == "103");
+
+  HandleDeque queue;
+  std::vector<DequeHandle> handles;
+  for (int i = 0; i < 20; ++i) {
+    queue.push_back(std::to_string(i));
+    handles.push_back(queue.handle(i));
+  }
+  for (int i = 0; i < 10; ++i) {
+    queue.push_front("front" + std::to_string(i));
+  }
+  queue.pop_back();
+  queue.pop_back();
+  for (int i = 0; i < 18; ++i) {
+    assert(*queue.resolve(handles[i]) == std::to_string(i));
+  }
+  assert(queue.resolve(handles[18]) == nullptr);
+  assert(queue.resolve(handles[19]) == nullptr);
+
+  queue.push_back("reused");
+  assert(queue.resolve(handles[18]) == nullptr);
+  DequeHandle reused = queue.handle(queue.size() - 1);
+  assert(*queue.resolve(reused) == "reused");
+  queue.pop_back();
+  queue.push_back("again");
+  assert(queue.resolve(reused) == nullptr);
+  assert(*queue.resolve(queue.handle(queue.size() - 1)) == "again");
+
+  DequeHandle front = queue.handle(0);
+  assert(*queue.resolve(front) == "front9");
+  queue.pop_front();
+  queue.push_front("replaced");
+  assert(queue.resolve(front) == nullptr);
+  DequeHandle replaced = queue.handle(0);
+  queue.push_front("newer");
+  queue.push_front("newest");
+  assert(*queue.resolve(replaced) == "replaced");
+  for (int i = 0; i < 18; ++i) {
+    assert(*queue.resolve(handles[i]) == std::to_string(i));
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    queue.push_front("grow" + std::to_string(i));
+    queue.push_back("grow" + std::to_string(i));
+  }
+  for (int i = 0; i < 18; ++i) {
+    assert(*queue.resolve(handles[i]) == std::to_string(i));
+  }
+  queue.pop_front();
+  queue.erase(queue.begin() + 5);
+  assert(queue.resolve(handles[0]) == nullptr);
+  DequeHandle middle = queue.handle(queue.size() - 3);
+  queue.insert(queue.end() - 2, "inserted");
+  assert(queue.resolve(middle) == nullptr);
+
+  check_random_operations(1);
+  check_random_operations(2);
+}
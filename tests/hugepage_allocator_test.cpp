@@ -0,0 +1,42 @@
+#include <cassert>
+#include <memory>
+
+#include "hugepage_allocator.hpp"
+
+int main() {
+  auto arena = std::make_shared<HugePageArena>();
+  HugePageAllocator<int> allocator(arena);
+  {
+    HugePageDeque<int> deque(allocator);
+    for (int i = 0; i < 100000; ++i) {
+      deque.push_back(i);
+      deque.push_front(-i);
+    }
+    for (int i = 0; i < 100000; ++i) {
+      assert(deque[100000 + i] == i && deque[99999 - i] == -i);
+    }
+    HugePageArenaStats stats = arena->stats();
+    assert(stats.regions > 0);
+    assert(stats.hugetlb_regions + stats.advised_regions == stats.regions);
+    assert(stats.mapped_bytes >= stats.regions * kHugePageSize);
+  }
+  HugePageArenaStats baseline = arena->stats();
+  int* large = allocator.allocate(kHugePageSize);
+  HugePageArenaStats grown = arena->stats();
+  assert(grown.regions == baseline.regions + 1);
+  assert(grown.mapped_bytes == baseline.mapped_bytes + 4 * kHugePageSize);
+  large[0] = 1;
+  large[kHugePageSize - 1] = 2;
+  allocator.deallocate(large, kHugePageSize);
+  HugePageArenaStats released = arena->stats();
+  assert(released.mapped_bytes == baseline.mapped_bytes);
+  assert(released.regions == baseline.regions);
+  assert(released.hugetlb_regions == baseline.hugetlb_regions &&
+         released.advised_regions == baseline.advised_regions &&
+         released.bound_regions == baseline.bound_regions);
+
+  HugePageAllocator<int> first;
+  HugePageAllocator<long> second;
+  assert(first == second);
+  assert(first.arena() == HugePageArena::default_arena());
+}
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "deque.hpp"
+
+template <typename BucketPolicy>
+void run(uint64_t seed) {
+  using TestDeque = Deque<long, std::allocator<long>, BucketPolicy>;
+  std::mt19937_64 random(seed);
+  TestDeque deque;
+  std::deque<long> reference;
+  for (int step = 0; step < 200000; ++step) {
+    long value = static_cast<long>(random() % 1000000);
+    switch (random() % 10) {
+      case 0:
+      case 1:
+      case 2:
+        deque.push_back(value);
+        reference.push_back(value);
+        break;
+      case 3:
+      case 4:
+        deque.push_front(value);
+        reference.push_front(value);
+        break;
+      case 5:
+        if (random() % 16 == 0) {
+          size_t count = random() % (reference.size() / 4 + 1);
+          deque.pop_back(count);
+          reference.resize(reference.size() - count);
+        } else if (!reference.empty()) {
+          deque.pop_back();
+          reference.pop_back();
+        }
+        break;
+      case 6:
+        if (random() % 16 == 0) {
+          size_t count = random() % (reference.size() / 4 + 1);
+          std::vector<long> drained;
+          if (random() % 2 == 0) {
+            deque.drain_front(count, std::back_inserter(drained));
+          } else {
+            deque.pop_front(count);
+            drained.assign(reference.begin(), reference.begin() + count);
+          }
+          assert(std::equal(drained.begin(), drained.end(), reference.begin(),
+                            reference.begin() + count));
+          reference.erase(reference.begin(), reference.begin() + count);
+        } else if (!reference.empty()) {
+          deque.pop_front();
+          reference.pop_front();
+        }
+        break;
+      case 7:
+        if (random() % 64 == 0) {
+          deque.reserve_back(random() % 200);
+        }
+        break;
+      case 8:
+        if (random() % 64 == 0) {
+          deque.reserve_front(random() % 200);
+        }
+        break;
+      case 9:
+        if (random() % 256 == 0) {
+          size_t index = 0;
+          for (long element : deque) {
+            assert(element == reference[index++]);
+          }
+          assert(index == reference.size());
+        }
+        break;
+    }
+    assert(deque.size() == reference.size());
+    if (!reference.empty()) {
+      size_t index = random() % reference.size();
+      assert(deque[index] == reference[index]);
+      assert(deque[0] == reference.front());
+      assert(deque[deque.size() - 1] == reference.back());
+    }
+  }
+  assert(deque.stats().reallocations > 10);
+  size_t index = 0;
+  for (auto element = deque.cbegin(); element != deque.cend(); ++element) {
+    assert(*element == reference[index++]);
+  }
+  assert(index == reference.size());
+}
+
+template <typename BucketPolicy>
+void drain_in_batches(size_t batch, bool from_front) {
+  using TestDeque = Deque<long, std::allocator<long>, BucketPolicy>;
+  TestDeque deque;
+  for (long i = 0; i < 1000; ++i) {
+    deque.push_back(i);
+  }
+  size_t reallocations = deque.stats().reallocations;
+  std::vector<long> drained;
+  while (!deque.empty()) {
+    size_t count = std::min(batch, deque.size());
+    if (from_front) {
+      deque.drain_front(count, std::back_inserter(drained));
+    } else {
+      assert(deque[deque.size() - 1] ==
+             static_cast<long>(deque.size()) - 1);
+      deque.pop_back(count);
+    }
+  }
+  assert(deque.stats().reallocations > reallocations);
+  for (size_t i = 0; i < drained.size(); ++i) {
+    assert(drained[i] == static_cast<long>(i));
+  }
+}
+
+int main() {
+  run<StatsBucketPolicy<IncrementalGrowthPolicy<FixedBucketPolicy<1>, 1>>>(1);
+  run<StatsBucketPolicy<IncrementalGrowthPolicy<FixedBucketPolicy<2>, 1>>>(2);
+  run<StatsBucketPolicy<IncrementalGrowthPolicy<FixedBucketPolicy<4>, 2>>>(3);
+  using BatchPolicy =
+      StatsBucketPolicy<IncrementalGrowthPolicy<FixedBucketPolicy<1>, 4>>;
+  drain_in_batches<BatchPolicy>(2, true);
+  drain_in_batches<BatchPolicy>(3, true);
+  drain_in_batches<BatchPolicy>(2, false);
+  drain_in_batches<BatchPolicy>(3, false);
+}
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+#include "deque.hpp"
+
+using SmallBucketDeque = Deque<int, std::allocator<int>, FixedBucketPolicy<4>>;
+
+static_assert(std::random_access_iterator<SmallBucketDeque::iterator>);
+static_assert(std::random_access_iterator<SmallBucketDeque::const_iterator>);
+
+int main() {
+  SmallBucketDeque empty;
+  assert(empty.begin() == empty.end() && empty.cbegin() == empty.cend());
+  assert(empty.end() - empty.begin() == 0 && !(empty.begin() < empty.end()));
+  assert(empty.rbegin() == empty.rend());
+  empty.push_back(1);
+  empty.pop_front();
+  assert(empty.begin() == empty.end() && empty.cend() - empty.cbegin() == 0);
+
+  for (int front = 0; front < 9; ++front) {
+    SmallBucketDeque deque;
+    for (int i = 0; i < 30; ++i) {
+      deque.push_back(i);
+    }
+    for (int i = 1; i <= front; ++i) {
+      deque.push_front(-i);
+    }
+    int size = static_cast<int>(deque.size());
+    auto first = deque.begin();
+    auto last = deque.end();
+    assert(last - first == size && first - last == -size);
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j <= size; ++j) {
+        assert((first + j) - (first + i) == j - i);
+        assert(((first + i) < (first + j)) == (i < j));
+        assert(((first + i) == (first + j)) == (i == j));
+        assert(last - (size - j) == first + j);
+      }
+      assert(first[i] == i - front && *(last - (size - i)) == i - front);
+      auto moved = first + i;
+      moved += size - i;
+      assert(moved == last);
+      moved -= size - i;
+      assert(*moved == i - front && &*moved == &deque[i]);
+    }
+    int expected = -front;
+    for (auto element = deque.cbegin(); element != deque.cend(); ++element) {
+      assert(*element == expected++);
+    }
+    assert(expected == 30);
+    for (auto element = deque.end(); element != deque.begin();) {
+      assert(*--element == --expected);
+    }
+    assert(expected == -front);
+    assert(std::is_sorted(deque.begin(), deque.end()));
+    std::reverse(deque.begin(), deque.end());
+    assert(std::is_sorted(deque.rbegin(), deque.rend()));
+  }
+}
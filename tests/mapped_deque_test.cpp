@@ -0,0 +1,54 @@
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "mapped_deque.hpp"
+
+int main() {
+  std::string path = (std::filesystem::temp_directory_path() /
+                      ("mapped_deque_test." + std::to_string(::getpid())))
+                         .string();
+  std::filesystem::remove(path);
+  {
+    MappedDeque<uint64_t> deque(path);
+    deque.push_back(0);
+    for (uint64_t i = 1; i < 100000; ++i) {
+      deque.push_back(deque[0]);
+      deque.push_front(deque[deque.size() - 1]);
+    }
+    assert(deque.size() == 199999);
+    for (size_t i = 0; i < deque.size(); ++i) {
+      assert(deque[i] == 0);
+    }
+    for (size_t i = 0; i < deque.size(); ++i) {
+      deque[i] = i;
+    }
+    deque.sync();
+  }
+  {
+    MappedDeque<uint64_t> deque(path);
+    assert(deque.size() == 199999);
+    for (size_t i = 0; i < deque.size(); ++i) {
+      assert(deque[i] == i);
+    }
+    for (int i = 0; i < 1000; ++i) {
+      deque.pop_front();
+      deque.pop_back();
+    }
+    for (uint64_t i = 0; i < 50000; ++i) {
+      deque.push_back(1000000 + i);
+    }
+    deque.sync();
+  }
+  {
+    MappedDeque<uint64_t> deque(path);
+    assert(deque.size() == 199999 - 2000 + 50000);
+    assert(deque[0] == 1000);
+    assert(deque[199999 - 2001] == 199999 - 1001);
+    assert(deque[deque.size() - 1] == 1049999);
+  }
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,75 @@
+#include <cassert>
+#include <cstddef>
+#include <memory_resource>
+
+#include "pmr_deque.hpp"
+
+using namespace std;
+
+class CountingResource : public pmr::memory_resource {
+ public:
+  size_t allocations = 0;
+  size_t deallocations = 0;
+  size_t bytes = 0;
+
+ private:
+  void* do_allocate(size_t size, size_t alignment) override {
+    ++allocations;
+    bytes += size;
+    return pmr::new_delete_resource()->allocate(size, alignment);
+  }
+  void do_deallocate(void* pointer, size_t size, size_t alignment) override {
+    ++deallocations;
+    pmr::new_delete_resource()->deallocate(pointer, size, alignment);
+  }
+  bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+using Policy = FixedBucketPolicy<16>;
+using Arena = BucketArenaResource<int, Policy>;
+
+int main() {
+  CountingResource upstream;
+  {
+    Arena arena(&upstream);
+    void* first = arena.allocate(Arena::kBlockBytes, alignof(int));
+    void* second = arena.allocate(Arena::kBlockBytes, alignof(int));
+    size_t upstream_allocations = upstream.allocations;
+    arena.deallocate(first, Arena::kBlockBytes, alignof(int));
+    arena.deallocate(second, Arena::kBlockBytes, alignof(int));
+    assert(arena.allocate(Arena::kBlockBytes, alignof(int)) == second);
+    assert(arena.allocate(Arena::kBlockBytes, alignof(int)) == first);
+    assert(upstream.allocations == upstream_allocations);
+
+    size_t upstream_bytes = upstream.bytes;
+    void* large = arena.allocate(64 * Arena::kBlockBytes, alignof(int));
+    assert(large != first && large != second);
+    assert(upstream.allocations > upstream_allocations);
+    assert(upstream.bytes - upstream_bytes >= 64 * Arena::kBlockBytes);
+    arena.deallocate(large, 64 * Arena::kBlockBytes, alignof(int));
+    void* odd = arena.allocate(Arena::kBlockBytes + 8, alignof(int));
+    assert(odd != first && odd != second && odd != large);
+
+    {
+      PmrDeque<int, Policy> deque(&arena);
+      for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 1000; ++i) {
+          deque.push_back(i);
+        }
+        if (round == 0) {
+          upstream_allocations = upstream.allocations;
+        }
+        for (int i = 0; i < 1000; ++i) {
+          assert(deque[0] == i);
+          deque.pop_front();
+        }
+      }
+      assert(upstream.allocations == upstream_allocations);
+    }
+    arena.release();
+    assert(upstream.deallocations == upstream.allocations);
+  }
+  assert(upstream.deallocations == upstream.allocations);
+}
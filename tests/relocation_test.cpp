@@ -0,0 +1,200 @@
+#include <cassert>
+#include <set>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "deque.hpp"
+
+struct Point {
+  int x;
+  int y;
+};
+
+struct Owner {
+  explicit Owner(int value) : value(new int(value)) {
+    owned.insert(this->value);
+  }
+  Owner(const Owner& other) : Owner(*other.value) {}
+  Owner(Owner&& other) noexcept : value(std::exchange(other.value, nullptr)) {}
+  Owner& operator=(const Owner& other) {
+    Owner copy(other);
+    std::swap(value, copy.value);
+    return *this;
+  }
+  Owner& operator=(Owner&& other) noexcept {
+    std::swap(value, other.value);
+    return *this;
+  }
+  ~Owner() {
+    if (value != nullptr) {
+      assert(owned.erase(value) == 1);
+      delete value;
+    }
+  }
+
+  static inline std::set<const int*> owned;
+  int* value;
+};
+
+template <>
+struct IsTriviallyRelocatable<Owner> : std::true_type {};
+
+struct Fragile {
+  explicit Fragile(int value) : value(value) { live.insert(this); }
+  Fragile(const Fragile& other) : value(other.value) {
+    assert(live.contains(&other));
+    if (value == throw_on) {
+      throw std::runtime_error("copy");
+    }
+    live.insert(this);
+  }
+  Fragile& operator=(const Fragile& other) = default;
+  ~Fragile() { assert(live.erase(this) == 1); }
+
+  static inline std::set<const Fragile*> live;
+  static inline int throw_on = -1;
+  int value;
+};
+
+template <typename Element>
+using SmallBucketDeque =
+    Deque<Element, std::allocator<Element>, FixedBucketPolicy<4>>;
+
+int value_of(const Point& point) { return point.x; }
+int value_of(const Owner& owner) { return *owner.value; }
+int value_of(const Fragile& fragile) { return fragile.value; }
+
+template <typename Container>
+std::vector<int> values(const Container& container) {
+  std::vector<int> result;
+  for (auto element = container.cbegin(); element != container.cend();
+       ++element) {
+    result.push_back(value_of(*element));
+  }
+  return result;
+}
+
+template <typename Element>
+std::vector<Element> make_range(int first, int count) {
+  std::vector<Element> range;
+  for (int i = first; i < first + count; ++i) {
+    if constexpr (std::is_same_v<Element, Point>) {
+      range.push_back(Point{i, -i});
+    } else {
+      range.emplace_back(i);
+    }
+  }
+  return range;
+}
+
+std::vector<int> iota(int first, int count) {
+  std::vector<int> result;
+  for (int i = first; i < first + count; ++i) {
+    result.push_back(i);
+  }
+  return result;
+}
+
+template <typename Element>
+void check_bulk_paths() {
+  SmallBucketDeque<Element> deque;
+  deque.append_range(make_range<Element>(0, 11));
+  deque.prepend_range(make_range<Element>(-7, 7));
+  assert(values(deque) == iota(-7, 18));
+
+  SmallBucketDeque<Element> copy(deque);
+  assert(values(copy) == iota(-7, 18));
+  copy = deque;
+  assert(values(copy) == iota(-7, 18));
+
+  auto inserted = make_range<Element>(100, 9);
+  deque.insert(deque.begin() + 3, inserted.begin(), inserted.end());
+  deque.insert(deque.end() - 2, inserted.begin(), inserted.begin() + 5);
+  std::vector<int> expected = iota(-7, 18);
+  std::vector<int> middle = iota(100, 9);
+  expected.insert(expected.begin() + 3, middle.begin(), middle.end());
+  expected.insert(expected.end() - 2, middle.begin(), middle.begin() + 5);
+  assert(values(deque) == expected);
+
+  deque.erase(deque.begin() + 2, deque.begin() + 9);
+  expected.erase(expected.begin() + 2, expected.begin() + 9);
+  deque.erase(deque.end() - 9, deque.end() - 3);
+  expected.erase(expected.end() - 9, expected.end() - 3);
+  assert(values(deque) == expected);
+
+  for (int round = 0; round < 10; ++round) {
+    deque.erase(deque.begin() + deque.size() / 2);
+    expected.erase(expected.begin() + expected.size() / 2);
+  }
+  assert(values(deque) == expected);
+}
+
+void check_inline_relocation() {
+  SmallDeque<Owner, 8> deque;
+  for (int i = 0; i < 4; ++i) {
+    deque.emplace_back(i);
+  }
+  for (int i = 1; i <= 4; ++i) {
+    deque.emplace_front(-i);
+  }
+  assert(values(deque) == iota(-4, 8));
+  assert(Owner::owned.size() == 8);
+  deque.emplace_back(4);
+  assert(values(deque) == iota(-4, 9));
+  assert(Owner::owned.size() == 9);
+}
+
+void check_rollback() {
+  SmallBucketDeque<Fragile> deque;
+  deque.append_range(make_range<Fragile>(0, 6));
+  std::vector<int> expected = iota(0, 6);
+  std::vector<Fragile> source = make_range<Fragile>(10, 13);
+
+  for (int throw_on : {10, 12, 16, 22}) {
+    Fragile::throw_on = throw_on;
+    bool thrown = false;
+    try {
+      deque.append_range(source);
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    assert(thrown && values(deque) == expected);
+    thrown = false;
+    try {
+      deque.prepend_range(source);
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    assert(thrown && values(deque) == expected);
+    thrown = false;
+    try {
+      deque.insert(deque.begin() + 2, source.begin(), source.end());
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    assert(thrown && values(deque) == expected);
+    assert(Fragile::live.size() == deque.size() + source.size());
+  }
+
+  Fragile::throw_on = 3;
+  bool thrown = false;
+  try {
+    SmallBucketDeque<Fragile> copy(deque);
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  assert(thrown && Fragile::live.size() == deque.size() + source.size());
+  Fragile::throw_on = -1;
+}
+
+int main() {
+  check_bulk_paths<Point>();
+  check_bulk_paths<Owner>();
+  assert(Owner::owned.empty());
+  check_inline_relocation();
+  assert(Owner::owned.empty());
+  check_rollback();
+  assert(Fragile::live.empty());
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <iterator>
+#include <stdexcept>
+
+#include "ring_deque.hpp"
+
+struct Counted {
+  explicit Counted(int value) : value(value) { ++alive; }
+  Counted(const Counted& other) : value(other.value) { ++alive; }
+  ~Counted() { --alive; }
+
+  static inline int alive = 0;
+  int value;
+};
+
+using SmallRing = RingDeque<int, std::allocator<int>, FixedBucketPolicy<4>>;
+
+static_assert(std::random_access_iterator<SmallRing::iterator>);
+static_assert(std::random_access_iterator<SmallRing::const_iterator>);
+
+template <typename Ring>
+void check(const Ring& ring, const std::deque<int>& reference) {
+  assert(ring.size() == reference.size());
+  assert(ring.empty() == reference.empty());
+  assert(std::equal(ring.cbegin(), ring.cend(), reference.begin(),
+                    reference.end()));
+  for (size_t i = 0; i < reference.size(); ++i) {
+    assert(ring[i] == reference[i]);
+  }
+}
+
+int main() {
+  SmallRing ring(10);
+  std::deque<int> reference;
+  assert(ring.empty() && !ring.full() && ring.capacity() == 10);
+  for (int i = 0; i < 100; ++i) {
+    ring.push_back(i);
+    reference.push_back(i);
+    if (ring.size() > 7) {
+      ring.pop_front();
+      reference.pop_front();
+    }
+    check(ring, reference);
+  }
+  for (int i = 0; i < 100; ++i) {
+    ring.push_front(-i);
+    reference.push_front(-i);
+    if (ring.size() > 7) {
+      ring.pop_back();
+      reference.pop_back();
+    }
+    check(ring, reference);
+  }
+
+  while (!ring.full()) {
+    ring.push_back(1000);
+    reference.push_back(1000);
+  }
+  check(ring, reference);
+  bool thrown = false;
+  try {
+    ring.push_front(1);
+  } catch (const std::length_error&) {
+    thrown = true;
+  }
+  assert(thrown);
+  thrown = false;
+  try {
+    ring.push_back(1);
+  } catch (const std::length_error&) {
+    thrown = true;
+  }
+  assert(thrown);
+  check(ring, reference);
+  for (int i = 0; i < 25; ++i) {
+    ring.push_back_overwrite(2000 + i);
+    reference.push_back(2000 + i);
+    reference.pop_front();
+    assert(ring.full() && ring.front() == reference.front() &&
+           ring.back() == reference.back());
+  }
+  check(ring, reference);
+  while (!ring.empty()) {
+    ring.pop_front();
+    reference.pop_front();
+  }
+  check(ring, reference);
+  ring.push_front(7);
+  assert(ring.size() == 1 && ring.front() == 7 && ring.back() == 7);
+  ring.pop_back();
+  assert(ring.empty() && ring.begin() == ring.end());
+
+  for (int shift = 0; shift < 16; ++shift) {
+    SmallRing seam(10);
+    for (int i = 0; i < shift; ++i) {
+      seam.push_back(0);
+      seam.pop_front();
+    }
+    for (int i = 0; i < 10; ++i) {
+      seam.push_back(9 - i);
+    }
+    auto first = seam.begin();
+    auto last = seam.end();
+    assert(last - first == 10 && first - last == -10);
+    for (int i = 0; i < 10; ++i) {
+      assert(&first[i] == &seam[i] && &*(first + i) == &seam[i]);
+      assert(&*(last - (10 - i)) == &seam[i]);
+      assert(first + i < last && last - (10 - i) >= first);
+    }
+    auto middle = first;
+    middle += 7;
+    middle -= 2;
+    assert(middle - first == 5 && *middle == 4);
+    assert(*std::prev(last) == 0 && *std::next(first) == 8);
+    std::sort(seam.begin(), seam.end());
+    for (int i = 0; i < 10; ++i) {
+      assert(seam[i] == i);
+    }
+    int expected = 9;
+    for (auto element = seam.rbegin(); element != seam.rend(); ++element) {
+      assert(*element == expected--);
+    }
+  }
+
+  {
+    RingDeque<Counted, std::allocator<Counted>, FixedBucketPolicy<4>> counted(
+        5);
+    for (int i = 0; i < 20; ++i) {
+      counted.push_back_overwrite(Counted(i));
+      assert(Counted::alive == static_cast<int>(counted.size()));
+    }
+    assert(counted.front().value == 15 && counted.back().value == 19);
+    counted.pop_front();
+    counted.pop_back();
+    assert(Counted::alive == 3);
+    RingDeque<Counted, std::allocator<Counted>, FixedBucketPolicy<4>> copy(
+        counted);
+    assert(Counted::alive == 6 && copy[0].value == 16);
+  }
+  assert(Counted::alive == 0);
+}
@@ -0,0 +1,107 @@
+#include <cassert>
+#include <set>
+#include <span>
+#include <string>
+#include <utility>
+
+#include "deque.hpp"
+
+struct Tracked {
+  explicit Tracked(std::string value) : value(std::move(value)) {
+    live.insert(this);
+  }
+  Tracked(const Tracked& other) : value(other.value) {
+    assert(live.contains(&other));
+    live.insert(this);
+  }
+  Tracked(Tracked&& other) noexcept : value(std::move(other.value)) {
+    live.insert(this);
+  }
+  Tracked& operator=(const Tracked& other) = default;
+  Tracked& operator=(Tracked&& other) = default;
+  ~Tracked() { live.erase(this); }
+
+  static inline std::set<const Tracked*> live;
+  std::string value;
+};
+
+using CountingSmallDeque =
+    Deque<int, std::allocator<int>,
+          StatsBucketPolicy<InlineStoragePolicy<DefaultBucketPolicy<int>, 8>>>;
+
+int main() {
+  static_assert(sizeof(SmallDeque<int, 8>) < 256);
+
+  CountingSmallDeque deque;
+  for (int round = 0; round < 100; ++round) {
+    for (int i = 0; i < 8; ++i) {
+      deque.push_back(round + i);
+    }
+    for (int i = 0; i < 8; ++i) {
+      assert(deque[0] == round + i);
+      deque.pop_front();
+    }
+    deque.push_front(round);
+    deque.pop_back();
+  }
+  assert(deque.stats().bucket_allocations == 0);
+
+  for (int i = 0; i < 1000000; ++i) {
+    deque.push_back(i);
+  }
+  assert(deque.stats().bucket_allocations <= 1000000 / 1024 + 4);
+  for (int i = 0; i < 1000000; ++i) {
+    assert(deque[i] == i);
+  }
+
+  SmallDeque<std::string, 4> small;
+  for (int i = 0; i < 4; ++i) {
+    small.push_back(std::string(32, 'a' + i));
+  }
+  small.pop_front();
+  small.push_back(small[0]);
+  small.push_front(small[3]);
+  assert(small.size() == 5 && small[0] == small[4]);
+  assert(small[0] == std::string(32, 'b'));
+  small.insert(small.begin() + 2, "middle");
+  assert(small[2] == "middle" && small.size() == 6);
+
+  SmallDeque<std::string, 4> inline_only;
+  inline_only.push_back("x");
+  inline_only.push_front("w");
+  SmallDeque<std::string, 4> moved(std::move(inline_only));
+  assert(inline_only.empty() && moved.size() == 2 && moved[0] == "w");
+  swap(moved, small);
+  assert(moved.size() == 6 && small.size() == 2 && small[1] == "x");
+  moved = small;
+  assert(moved.size() == 2 && moved[0] == "w" && moved[1] == "x");
+  moved.push_back("y");
+  moved.shrink_to_fit();
+  assert(moved.size() == 3 && moved[2] == "y");
+
+
+  std::string long_value(40, 'x');
+  SmallDeque<Tracked, 3> spilled;
+  spilled.push_back(Tracked(long_value));
+  spilled.push_back(Tracked("a"));
+  spilled.push_back(Tracked("b"));
+  spilled.insert(spilled.end(), 5, spilled[0]);
+  assert(spilled.size() == 8);
+  for (size_t i = 3; i < spilled.size(); ++i) {
+    assert(spilled[i].value == long_value);
+  }
+
+  SmallDeque<Tracked, 3> ranged;
+  ranged.push_back(Tracked(long_value));
+  ranged.push_back(Tracked("a"));
+  ranged.insert(ranged.begin() + 1, ranged.begin(), ranged.end());
+  assert(ranged.size() == 4 && ranged[1].value == long_value &&
+         ranged[2].value == "a" && ranged[3].value == "a");
+
+  SmallDeque<Tracked, 3> appended;
+  appended.push_back(Tracked(long_value));
+  appended.push_back(Tracked("a"));
+  appended.append_range(std::span(&appended[0], 2));
+  assert(appended.size() == 4 && appended[2].value == long_value &&
+         appended[3].value == "a");
+}
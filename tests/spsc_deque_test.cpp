@@ -0,0 +1,79 @@
+#include <atomic>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "spsc_deque.hpp"
+
+std::atomic<long> live_allocations{0};
+std::atomic<long> live_bucket_maps{0};
+
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+
+  CountingAllocator() = default;
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>&) {}
+
+  T* allocate(size_t count) {
+    ++live_allocations;
+    if constexpr (std::is_same_v<T, std::string*>) {
+      ++live_bucket_maps;
+    }
+    return std::allocator<T>().allocate(count);
+  }
+
+  void deallocate(T* pointer, size_t count) {
+    --live_allocations;
+    if constexpr (std::is_same_v<T, std::string*>) {
+      --live_bucket_maps;
+    }
+    std::allocator<T>().deallocate(pointer, count);
+  }
+
+  template <typename U>
+  bool operator==(const CountingAllocator<U>&) const {
+    return true;
+  }
+};
+
+template <typename BucketPolicy>
+void run(long count) {
+  {
+    SpscDeque<std::string, CountingAllocator<std::string>, BucketPolicy> deque;
+    std::thread producer([&] {
+      for (long i = 0; i < count; ++i) {
+        deque.push_back(std::to_string(i));
+      }
+    });
+    std::string value;
+    for (long expected = 0; expected < count;) {
+      if (deque.try_pop_front(value)) {
+        assert(value == std::to_string(expected));
+        ++expected;
+      }
+    }
+    producer.join();
+    assert(deque.empty() && deque.front() == nullptr);
+    assert(live_bucket_maps <= 2);
+
+    for (long i = 0; i < count; ++i) {
+      deque.push_back(std::to_string(i));
+    }
+    assert(live_bucket_maps == 1);
+    assert(deque.size() == static_cast<size_t>(count));
+    for (long i = 0; i < count / 2; ++i) {
+      assert(*deque.front() == std::to_string(i));
+      deque.pop_front();
+    }
+  }
+  assert(live_allocations == 0 && live_bucket_maps == 0);
+}
+
+int main() {
+  run<FixedBucketPolicy<1>>(100000);
+  run<FixedBucketPolicy<4>>(200000);
+  run<DefaultBucketPolicy<std::string>>(200000);
+}
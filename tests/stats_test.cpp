@@ -0,0 +1,57 @@
+#include <cassert>
+
+#include "deque.hpp"
+
+using StatsDeque =
+    Deque<int, std::allocator<int>, StatsBucketPolicy<FixedBucketPolicy<4, 0>>>;
+
+int main() {
+  StatsDeque deque;
+  size_t callbacks = 0;
+  deque.set_growth_callback([&](const DequeStats& stats) {
+    ++callbacks;
+    assert(stats.reallocations == callbacks);
+  });
+  DequeStats stats = deque.stats();
+  assert(stats.reallocations == 0 && stats.bucket_allocations == 0 &&
+         stats.wasted_slots == 0);
+
+  deque.push_back(0);
+  stats = deque.stats();
+  assert(stats.reallocations == 1 && stats.bytes_moved == 0);
+  assert(stats.bucket_allocations == 1 && stats.peak_size == 1);
+  assert(stats.peak_container_capacity == 3 && stats.wasted_slots == 3);
+
+  for (int i = 1; i < 16; ++i) {
+    deque.push_back(i);
+  }
+  stats = deque.stats();
+  assert(stats.reallocations == 2 && stats.bytes_moved == 3 * sizeof(int*));
+  assert(stats.bucket_allocations == 5 && stats.peak_size == 16);
+  assert(stats.peak_container_capacity == 8 && stats.wasted_slots == 4);
+
+  for (int i = 0; i < 16; ++i) {
+    deque.push_front(i);
+  }
+  stats = deque.stats();
+  assert(stats.reallocations == 3 && stats.bytes_moved == 10 * sizeof(int*));
+  assert(stats.bucket_allocations == 9 && stats.bucket_deallocations == 0);
+  assert(stats.peak_size == 32 && stats.peak_container_capacity == 17);
+  assert(stats.wasted_slots == 4);
+
+  for (int i = 0; i < 24; ++i) {
+    deque.pop_back();
+  }
+  stats = deque.stats();
+  assert(stats.reallocations == 3 && stats.bucket_deallocations == 6);
+  assert(stats.peak_size == 32 && stats.wasted_slots == 4);
+  assert(callbacks == 3);
+
+  deque.reserve_back(100);
+  stats = deque.stats();
+  assert(callbacks == stats.reallocations);
+  assert(stats.peak_container_capacity >= 17);
+  assert((stats.bucket_allocations - stats.bucket_deallocations) * 4 ==
+         deque.size() + stats.wasted_slots);
+  assert(deque.size() + stats.wasted_slots >= 108);
+}
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "deque_parallel.hpp"
+
+std::atomic<int> started_threads{0};
+
+struct ThreadState {
+  ThreadState() { ++started_threads; }
+  void touch() {}
+};
+
+thread_local ThreadState thread_state;
+
+using ParallelDeque = Deque<long, std::allocator<long>, FixedBucketPolicy<64>>;
+
+ParallelDeque make_deque(size_t size, uint64_t seed) {
+  std::mt19937_64 random(seed);
+  ParallelDeque deque;
+  for (size_t i = 0; i < size; ++i) {
+    long value = static_cast<long>(random() % 1000);
+    if (i % 5 == 0) {
+      deque.push_front(value);
+    } else {
+      deque.push_back(value);
+    }
+  }
+  return deque;
+}
+
+std::vector<long> contents(const ParallelDeque& deque) {
+  return std::vector<long>(deque.cbegin(), deque.cend());
+}
+
+void check_algorithms(const ThreadExecutor& executor) {
+  for (size_t size : {0, 1, 63, 64, 1000, 20000}) {
+    ParallelDeque deque = make_deque(size, size);
+    std::vector<long> expected = contents(deque);
+    parallel_sort(deque, std::less<>{}, executor);
+    std::sort(expected.begin(), expected.end());
+    assert(contents(deque) == expected);
+    parallel_sort(deque, std::greater<>{}, executor);
+    std::sort(expected.begin(), expected.end(), std::greater<>{});
+    assert(contents(deque) == expected);
+
+    deque = make_deque(size, size + 1);
+    const ParallelDeque& view = deque;
+    expected = contents(deque);
+    for (long threshold : {-1L, 0L, 500L, 990L, 998L}) {
+      auto predicate = [&](long value) { return value > threshold; };
+      assert(parallel_find_if(view, predicate, executor) ==
+             std::find_if(view.cbegin(), view.cend(), predicate));
+    }
+    if (size > 100) {
+      for (size_t index : {size - 1, size / 2, size / 3, size_t{70}}) {
+        deque[index] = -1;
+        auto predicate = [](long value) { return value < 0; };
+        auto found = parallel_find_if(view, predicate, executor);
+        assert(found - view.cbegin() == static_cast<long>(index));
+      }
+    }
+    expected = contents(deque);
+
+    std::vector<long> squares(size + 1, -7);
+    auto square = [](long value) { return value * value; };
+    assert(parallel_transform(view, squares.begin(), square, executor) ==
+           squares.begin() + size);
+    for (size_t i = 0; i < size; ++i) {
+      assert(squares[i] == expected[i] * expected[i]);
+    }
+    assert(squares[size] == -7);
+
+    parallel_transform(deque, [](long value) { return value * 2 + 1; },
+                       executor);
+    for (size_t i = 0; i < size; ++i) {
+      assert(deque[i] == expected[i] * 2 + 1);
+    }
+
+    std::atomic<size_t> visited{0};
+    parallel_for_each(
+        deque,
+        [&](long& value) {
+          value -= 1;
+          ++visited;
+        },
+        executor);
+    assert(visited == size);
+    for (size_t i = 0; i < size; ++i) {
+      assert(deque[i] == expected[i] * 2);
+    }
+  }
+}
+
+int main() {
+  ThreadExecutor executor(4);
+  assert(executor.concurrency() == 4);
+
+  for (int round = 0; round < 100; ++round) {
+    executor.run(64, [](size_t) { thread_state.touch(); });
+  }
+  assert(started_threads <= 4);
+
+  std::atomic<size_t> nested{0};
+  executor.run(8, [&](size_t) {
+    executor.run(8, [&](size_t) { ++nested; });
+  });
+  assert(nested == 64);
+
+  bool threw = false;
+  try {
+    executor.run(100, [](size_t task) {
+      if (task == 42) {
+        throw std::runtime_error("task failed");
+      }
+    });
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  assert(threw);
+  std::atomic<size_t> completed{0};
+  executor.run(100, [&](size_t) { ++completed; });
+  assert(completed == 100);
+
+  Deque<long, std::allocator<long>, FixedBucketPolicy<64>> deque;
+  for (long i = 0; i < 100000; ++i) {
+    deque.push_back(i);
+  }
+  for (int round = 0; round < 50; ++round) {
+    assert(parallel_reduce(deque, 0L, std::plus<>{}) == 4999950000L);
+    assert(parallel_reduce(deque, 0L, std::plus<>{}, executor) ==
+           4999950000L);
+  }
+
+  for (size_t thread_count : {1, 2, 3, 4, 7}) {
+    check_algorithms(ThreadExecutor(thread_count));
+  }
+  check_algorithms(ThreadExecutor());
+}
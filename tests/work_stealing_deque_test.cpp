@@ -0,0 +1,50 @@
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+#include "work_stealing_deque.hpp"
+
+template <typename BucketPolicy>
+void run(long count, int thief_count) {
+  WorkStealingDeque<long, std::allocator<long>, BucketPolicy> deque;
+  std::vector<std::atomic<int>> taken(count);
+  std::atomic<bool> done{false};
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < thief_count; ++i) {
+    thieves.emplace_back([&] {
+      while (!done.load()) {
+        if (std::optional<long> value = deque.steal()) {
+          ++taken[*value];
+        }
+      }
+    });
+  }
+  for (long i = 0; i < count; ++i) {
+    deque.push_back(i);
+    if (i % 1000 >= 500 && i % 3 == 0) {
+      if (std::optional<long> value = deque.pop_back()) {
+        ++taken[*value];
+      }
+    }
+  }
+  while (std::optional<long> value = deque.pop_back()) {
+    ++taken[*value];
+  }
+  done = true;
+  for (std::thread& thief : thieves) {
+    thief.join();
+  }
+  assert(deque.empty() && !deque.steal().has_value());
+  for (long i = 0; i < count; ++i) {
+    assert(taken[i] == 1);
+  }
+}
+
+int main() {
+  for (int round = 0; round < 10; ++round) {
+    run<FixedBucketPolicy<1>>(20000, 3);
+    run<FixedBucketPolicy<4>>(50000, 4);
+  }
+  run<DefaultBucketPolicy<long>>(200000, 2);
+}
@@ -0,0 +1,255 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "deque.hpp"
+
+template <typename T, typename Allocator = std::allocator<T>,
+          typename BucketPolicy = DefaultBucketPolicy<T>>
+class WorkStealingDeque {
+ public:
+  WorkStealingDeque() = default;
+  explicit WorkStealingDeque(const Allocator& allocator);
+  WorkStealingDeque(const WorkStealingDeque& other) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque& other) = delete;
+  ~WorkStealingDeque();
+
+  void push_back(const T& value);
+  std::optional<T> pop_back();
+  std::optional<T> steal();
+
+  size_t size() const;
+  bool empty() const;
+
+  using allocator_type = Allocator;
+  using allocator_traits = std::allocator_traits<allocator_type>;
+
+  allocator_type get_allocator() const { return alloc_; }
+
+ private:
+  struct Container {
+    T** buckets;
+    size_t capacity;
+  };
+
+  using bucket_map_allocator =
+      typename allocator_traits::template rebind_alloc<T*>;
+  using bucket_map_allocator_traits =
+      std::allocator_traits<bucket_map_allocator>;
+  using container_allocator =
+      typename allocator_traits::template rebind_alloc<Container>;
+  using container_allocator_traits = std::allocator_traits<container_allocator>;
+  using retired_allocator =
+      typename allocator_traits::template rebind_alloc<Container*>;
+
+  static constexpr size_t kBucketSize = BucketPolicy::kBucketSize;
+  static constexpr size_t kBucketShift = std::countr_zero(kBucketSize);
+  static constexpr size_t kBucketMask = kBucketSize - 1;
+  static constexpr size_t kInitialCapacity = 4;
+  static constexpr size_t kCacheLine = 64;
+  static_assert(std::has_single_bit(kBucketSize),
+                "bucket size must be a power of two");
+  static_assert(std::is_trivially_copyable_v<T>,
+                "stolen elements are read before they are claimed");
+  static_assert(alignof(T) >= std::atomic_ref<T>::required_alignment,
+                "elements must be accessible through std::atomic_ref");
+
+  static std::optional<T> load(Container* container, std::ptrdiff_t index);
+  void reallocation(std::ptrdiff_t top, std::ptrdiff_t bottom);
+  Container* allocate_container(size_t capacity);
+  void release_container(Container* container);
+
+  alignas(kCacheLine) std::atomic<std::ptrdiff_t> top_{0};
+  alignas(kCacheLine) std::atomic<std::ptrdiff_t> bottom_{0};
+  std::atomic<Container*> container_{nullptr};
+  std::vector<Container*, retired_allocator> retired_;
+
+  allocator_type alloc_;
+  bucket_map_allocator bucket_map_alloc_{alloc_};
+  container_allocator container_alloc_{alloc_};
+};
+
+template <typename T, typename Allocator, typename BucketPolicy>
+WorkStealingDeque<T, Allocator, BucketPolicy>::WorkStealingDeque(
+    const Allocator& allocator)
+    : retired_(retired_allocator(allocator)),
+      alloc_(allocator),
+      bucket_map_alloc_(allocator),
+      container_alloc_(allocator) {}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+WorkStealingDeque<T, Allocator, BucketPolicy>::~WorkStealingDeque() {
+  Container* container = container_.load(std::memory_order_relaxed);
+  if (container != nullptr) {
+    for (size_t i = 0; i < container->capacity; ++i) {
+      if (container->buckets[i] != nullptr) {
+        allocator_traits::deallocate(alloc_, container->buckets[i],
+                                     kBucketSize);
+      }
+    }
+    release_container(container);
+  }
+  for (Container* retired : retired_) {
+    release_container(retired);
+  }
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void WorkStealingDeque<T, Allocator, BucketPolicy>::push_back(const T& value) {
+  std::ptrdiff_t bottom = bottom_.load(std::memory_order_relaxed);
+  std::ptrdiff_t top = top_.load(std::memory_order_acquire);
+  Container* container = container_.load(std::memory_order_relaxed);
+  size_t bucket_number = static_cast<size_t>(bottom) >> kBucketShift;
+  if (container == nullptr ||
+      bucket_number - (static_cast<size_t>(top) >> kBucketShift) >=
+          container->capacity) {
+    reallocation(top, bottom);
+    container = container_.load(std::memory_order_relaxed);
+  }
+  std::atomic_ref<T*> slot(
+      container->buckets[bucket_number & (container->capacity - 1)]);
+  T* bucket = slot.load(std::memory_order_relaxed);
+  if (bucket == nullptr) {
+    bucket = allocator_traits::allocate(alloc_, kBucketSize);
+    slot.store(bucket, std::memory_order_release);
+  }
+  std::atomic_ref<T>(bucket[bottom & kBucketMask])
+      .store(value, std::memory_order_relaxed);
+  bottom_.store(bottom + 1, std::memory_order_release);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+std::optional<T> WorkStealingDeque<T, Allocator, BucketPolicy>::pop_back() {
+  std::ptrdiff_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  Container* container = container_.load(std::memory_order_relaxed);
+  bottom_.store(bottom, std::memory_order_seq_cst);
+  std::ptrdiff_t top = top_.load(std::memory_order_seq_cst);
+  if (top > bottom) {
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+  std::optional<T> value = load(container, bottom);
+  if (top == bottom) {
+    bool claimed = top_.compare_exchange_strong(
+        top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    if (!claimed) {
+      return std::nullopt;
+    }
+  }
+  return value;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+std::optional<T> WorkStealingDeque<T, Allocator, BucketPolicy>::steal() {
+  std::ptrdiff_t top = top_.load(std::memory_order_seq_cst);
+  std::ptrdiff_t bottom = bottom_.load(std::memory_order_seq_cst);
+  if (top >= bottom) {
+    return std::nullopt;
+  }
+  std::optional<T> value =
+      load(container_.load(std::memory_order_acquire), top);
+  if (!value.has_value() ||
+      !top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+size_t WorkStealingDeque<T, Allocator, BucketPolicy>::size() const {
+  std::ptrdiff_t top = top_.load(std::memory_order_acquire);
+  std::ptrdiff_t bottom = bottom_.load(std::memory_order_acquire);
+  return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+bool WorkStealingDeque<T, Allocator, BucketPolicy>::empty() const {
+  return size() == 0;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+std::optional<T> WorkStealingDeque<T, Allocator, BucketPolicy>::load(
+    Container* container, std::ptrdiff_t index) {
+  T* bucket = std::atomic_ref<T*>(
+                  container->buckets[(static_cast<size_t>(index) >>
+                                      kBucketShift) &
+                                     (container->capacity - 1)])
+                  .load(std::memory_order_acquire);
+  if (bucket == nullptr) {
+    return std::nullopt;
+  }
+  return std::atomic_ref<T>(bucket[index & kBucketMask])
+      .load(std::memory_order_relaxed);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void WorkStealingDeque<T, Allocator, BucketPolicy>::reallocation(
+    std::ptrdiff_t top, std::ptrdiff_t bottom) {
+  Container* old_container = container_.load(std::memory_order_relaxed);
+  if (old_container == nullptr) {
+    container_.store(allocate_container(kInitialCapacity),
+                     std::memory_order_release);
+    return;
+  }
+  retired_.reserve(retired_.size() + 1);
+  size_t old_mask = old_container->capacity - 1;
+  Container* new_container = allocate_container(2 * old_container->capacity);
+  size_t new_mask = new_container->capacity - 1;
+  size_t first_bucket = static_cast<size_t>(top) >> kBucketShift;
+  size_t live_buckets =
+      top < bottom
+          ? ((static_cast<size_t>(bottom) - 1) >> kBucketShift) -
+                first_bucket + 1
+          : 0;
+  for (size_t i = 0; i < live_buckets; ++i) {
+    new_container->buckets[(first_bucket + i) & new_mask] =
+        old_container->buckets[(first_bucket + i) & old_mask];
+  }
+  size_t free_slot = 0;
+  for (size_t i = 0; i < old_container->capacity; ++i) {
+    if (((i - first_bucket) & old_mask) < live_buckets ||
+        old_container->buckets[i] == nullptr) {
+      continue;
+    }
+    while (new_container->buckets[free_slot] != nullptr) {
+      ++free_slot;
+    }
+    new_container->buckets[free_slot] = old_container->buckets[i];
+  }
+  container_.store(new_container, std::memory_order_release);
+  retired_.push_back(old_container);
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+typename WorkStealingDeque<T, Allocator, BucketPolicy>::Container*
+WorkStealingDeque<T, Allocator, BucketPolicy>::allocate_container(
+    size_t capacity) {
+  Container* container =
+      container_allocator_traits::allocate(container_alloc_, 1);
+  try {
+    container->buckets =
+        bucket_map_allocator_traits::allocate(bucket_map_alloc_, capacity);
+  } catch (...) {
+    container_allocator_traits::deallocate(container_alloc_, container, 1);
+    throw;
+  }
+  container->capacity = capacity;
+  for (size_t i = 0; i < capacity; ++i) {
+    bucket_map_allocator_traits::construct(bucket_map_alloc_,
+                                           container->buckets + i, nullptr);
+  }
+  return container;
+}
+
+template <typename T, typename Allocator, typename BucketPolicy>
+void WorkStealingDeque<T, Allocator, BucketPolicy>::release_container(
+    Container* container) {
+  bucket_map_allocator_traits::deallocate(bucket_map_alloc_,
+                                          container->buckets,
+                                          container->capacity);
+  container_allocator_traits::deallocate(container_alloc_, container, 1);
+}